@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// differential_harness.cpp
+//
+// Runs the differential validation of lis_differential.hpp on many random
+// inputs and prints every failure with its minimized reproducer.
+//
+// usage: differential_harness [cases [max_size [seed]]]
+//
+// Exits with status 1 when any engine disagrees.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <iostream>
+
+#include "timer.hpp"
+
+#include "lis_differential.hpp"
+
+void print_bar() {
+  std::cout << std::string(79, '-') << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+  const size_t cases = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const size_t max_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+  const unsigned seed = argc > 3 ? unsigned(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  work_stealing_pool pool;
+  const auto engines = lis_engines();
+
+  print_bar();
+  std::cout << cases << " inputs of size 1 to " << max_size << ", seed " << seed
+            << ", " << pool.size() << " threads" << std::endl
+            << "engines:";
+  for (auto& engine : engines) {
+    std::cout << " " << engine.name;
+  }
+  std::cout << std::endl;
+
+  Timer timer;
+  auto report = run_differential(pool, engines, cases, max_size, seed);
+  const double elapsed = timer.elapsed();
+
+  print_bar();
+  for (auto& failure : report.failures) {
+    std::cout << "FAILED " << failure.problem << std::endl
+              << "  input     " << sequence_to_string(failure.input) << std::endl
+              << "  minimized " << sequence_to_string(failure.minimized) << std::endl
+              << "  problem   " << differential_check(failure.minimized, engines) << std::endl;
+  }
+  std::cout << report.cases << " inputs checked, " << report.failures.size()
+            << " failures, elapsed time=" << elapsed << " seconds" << std::endl;
+  print_bar();
+
+  return report.failures.empty() ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamic_benchmark.cpp
+//
+// Benchmark of dynamic_lis against recomputing the LIS from scratch with
+// longest_increasing_patience, on workloads that mix point updates and
+// length queries.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "timer.hpp"
+
+#include "lis_dynamic.hpp"
+#include "lis_patience.hpp"
+#include "subsequence.hpp"
+
+void print_bar() {
+  std::cout << std::string(79, '-') << std::endl;
+}
+
+// Apply updates at the given positions, querying the length after every
+// updates_per_query updates, once with dynamic_lis and once by recomputing.
+void run(const std::string& name, sequence values,
+         const std::vector<size_t>& positions, const sequence& updates,
+         size_t updates_per_query) {
+
+  dynamic_lis<int> dynamic(values);
+  size_t dynamic_total = 0, scratch_total = 0;
+
+  Timer timer;
+  for (size_t k = 0; k < positions.size(); ++k) {
+    dynamic.update(positions[k], updates[k]);
+    if ((k + 1) % updates_per_query == 0) {
+      dynamic_total += dynamic.lis_length();
+    }
+  }
+  const double dynamic_elapsed = timer.elapsed();
+
+  timer.reset();
+  for (size_t k = 0; k < positions.size(); ++k) {
+    values[positions[k]] = updates[k];
+    if ((k + 1) % updates_per_query == 0) {
+      scratch_total += longest_increasing_patience(values).size();
+    }
+  }
+  const double scratch_elapsed = timer.elapsed();
+
+  assert(dynamic_total == scratch_total);
+  std::cout << name << "\t" << updates_per_query << "\t\t"
+            << dynamic_elapsed << "\t" << scratch_elapsed << std::endl;
+}
+
+int main() {
+
+  const size_t n = 1000000, edits = 500;
+  const auto values = random_sequence(n, 0, 1000000);
+  const auto updates = random_sequence(edits, 1, 1000000);
+
+  // edits anywhere, and edits among the most recent 1% of the samples
+  std::vector<size_t> anywhere, recent;
+  for (auto p : random_sequence(edits, 2, n - 1)) {
+    anywhere.push_back(p);
+    recent.push_back(n - 1 - p / 100);
+  }
+
+  print_bar();
+  std::cout << "n = " << n << ", " << edits << " updates, seconds" << std::endl
+            << "edits\tupdates/query\tdynamic_lis\trecompute" << std::endl;
+  for (size_t per_query : {1, 10, 100}) {
+    run("anywhere", values, anywhere, updates, per_query);
+    run("recent", values, recent, updates, per_query);
+  }
+
+  return 0;
+}
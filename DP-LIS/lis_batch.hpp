@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_batch.hpp
+//
+// Batch interface to the dynamic programming LIS algorithm, for workloads of
+// many short sequences. The sequences are passed in one flat buffer in CSR
+// layout: sequence s occupies values[offsets[s] .. offsets[s+1]), so offsets
+// has one more entry than there are sequences. Each result fits in the slot
+// of its input, so all results are written to a single output buffer with the
+// same layout, plus one length per sequence.
+//
+// The sequences are spread over a work_stealing_pool. Each worker thread
+// keeps its H array between sequences (and between batches), so a batch
+// performs no per-sequence allocation.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "subsequence.hpp"
+#include "work_stealing_pool.hpp"
+
+// Number of sequences a worker claims at a time.
+const size_t LIS_BATCH_GRAIN = 16;
+
+// Per-thread H array used as scratch space by the batch algorithm.
+inline std::vector<size_t>& lis_thread_scratch() {
+  thread_local std::vector<size_t> H;
+  return H;
+}
+
+// Solve every sequence of a CSR batch. For each s < count, the longest
+// increasing subsequence of values[offsets[s] .. offsets[s+1]) is written to
+// out_values starting at out_values + offsets[s], and its length to
+// out_lengths[s]. The results are exactly those of
+// longest_increasing_end_to_beginning on each sequence.
+template <typename T,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+void longest_increasing_batch(work_stealing_pool& pool,
+                              const T* values, const size_t* offsets,
+                              size_t count,
+                              T* out_values, size_t* out_lengths,
+                              Compare comp = Compare(),
+                              Projection proj = Projection()) {
+
+  pool.parallel_for(count, LIS_BATCH_GRAIN,
+                    [&](unsigned, size_t begin, size_t end) {
+    auto& H = lis_thread_scratch();
+    for (size_t s = begin; s < end; ++s) {
+      assert(offsets[s] <= offsets[s+1]);
+      const T* A = values + offsets[s];
+      const size_t n = offsets[s+1] - offsets[s];
+      const size_t max = end_to_beginning_heights(A, n, H, comp, proj);
+      end_to_beginning_trace(A, n, H.begin(), max, out_values + offsets[s]);
+      out_lengths[s] = max;
+    }
+  });
+}
+
+// Results of a batch, in the layout of the input batch.
+struct lis_batch_result {
+  sequence values;
+  std::vector<size_t> offsets;
+  std::vector<size_t> lengths;
+
+  size_t size() const {
+    return lengths.size();
+  }
+
+  // Copy out the result for sequence s.
+  sequence subsequence(size_t s) const {
+    assert(s < size());
+    return sequence(values.begin() + offsets[s],
+                    values.begin() + offsets[s] + lengths[s]);
+  }
+};
+
+// Convenience overload for a batch of int sequences held in vectors.
+lis_batch_result longest_increasing_batch(work_stealing_pool& pool,
+                                          const sequence& values,
+                                          const std::vector<size_t>& offsets) {
+  assert(!offsets.empty());
+  assert(offsets.back() == values.size());
+
+  lis_batch_result result;
+  result.values.resize(values.size());
+  result.offsets = offsets;
+  result.lengths.resize(offsets.size() - 1);
+
+  longest_increasing_batch(pool, values.data(), offsets.data(),
+                           result.size(),
+                           result.values.data(), result.lengths.data());
+  return result;
+}
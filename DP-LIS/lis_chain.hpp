@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_chain.hpp
+//
+// Longest chain of two-dimensional items that is strictly increasing in both
+// coordinates (the "envelope nesting" problem), in O(n log n).
+//
+// Sorting the items by their first key reduces the problem to a 1D LIS on
+// the second key. Among items with equal first keys, at most one may be
+// chosen, so those are sorted by descending second key: then no two of them
+// form an increasing pair and the 1D LIS can pick at most one.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lis_patience.hpp"
+#include "subsequence.hpp"
+
+// Projections selecting the coordinates of a std::pair.
+struct first_key {
+  template <typename Pair>
+  const typename Pair::first_type& operator()(const Pair& p) const {
+    return p.first;
+  }
+};
+
+struct second_key {
+  template <typename Pair>
+  const typename Pair::second_type& operator()(const Pair& p) const {
+    return p.second;
+  }
+};
+
+// The "may follow" relation of a chain: b dominates a in both coordinates.
+template <typename FirstKey = first_key, typename SecondKey = second_key>
+struct dominates {
+  FirstKey first;
+  SecondKey second;
+
+  template <typename T>
+  bool operator()(const T& a, const T& b) const {
+    return first(a) < first(b) && second(a) < second(b);
+  }
+};
+
+// Return true when chain is strictly increasing in both coordinates.
+template <typename Range,
+          typename FirstKey = first_key,
+          typename SecondKey = second_key>
+bool is_dominance_chain(const Range& chain,
+                        FirstKey first = FirstKey(),
+                        SecondKey second = SecondKey()) {
+  return is_increasing(chain, dominates<FirstKey, SecondKey>{first, second});
+}
+
+// Longest chain of items that strictly increases in both first(item) and
+// second(item), listed in chain order.
+template <typename Range,
+          typename FirstKey = first_key,
+          typename SecondKey = second_key>
+auto longest_dominance_chain(const Range& items,
+                             FirstKey first = FirstKey(),
+                             SecondKey second = SecondKey()) {
+  using value_type = typename std::decay<decltype(*std::begin(items))>::type;
+
+  std::vector<value_type> sorted(std::begin(items), std::end(items));
+  std::sort(sorted.begin(), sorted.end(),
+            [&](const value_type& a, const value_type& b) {
+              if (first(a) < first(b)) {
+                return true;
+              }
+              if (first(b) < first(a)) {
+                return false;
+              }
+              return second(b) < second(a);
+            });
+
+  return longest_increasing_patience(sorted.begin(), sorted.end(),
+                                     std::less<>(), second);
+}
@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_differential.hpp
+//
+// Differential validation of the LIS engines: the exhaustive searches of
+// ../exhaustive-LIS, the end-to-beginning DP and the fast engines are run
+// on the same random inputs and must agree.
+//
+// For every input the DP gives the reference length, and each engine's
+// output must have that length, be increasing, and be a subsequence of the
+// input. Inputs are drawn with random_sequence, with sizes cycling from 1 to
+// a maximum and value ranges alternating between tie-heavy and mostly
+// distinct, and are checked in parallel on a work_stealing_pool. Every
+// failing input is then minimized: elements are deleted and values lowered
+// for as long as the failure persists, which leaves a small reproducer.
+//
+// The exhaustive project's headers declare their sequence helpers in
+// namespace exhaustive, apart from the ones of subsequence.hpp.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../exhaustive-LIS/subsequence.hpp"
+#include "lis_patience.hpp"
+#include "lis_universe.hpp"
+#include "subsequence.hpp"
+#include "work_stealing_pool.hpp"
+
+// An engine under test; inputs longer than max_size are skipped, which keeps
+// the exponential engines to sizes they finish quickly.
+struct lis_engine {
+  const char* name;
+  sequence (*solve)(const sequence&);
+  size_t max_size;
+};
+
+std::vector<lis_engine> lis_engines() {
+  return {
+    {"powerset", [](const sequence& A) { return exhaustive::longest_increasing_powerset(A); }, 12},
+    {"gray code", [](const sequence& A) { return exhaustive::longest_increasing_gray_code(A); }, 20},
+    {"branch and bound", [](const sequence& A) { return exhaustive::longest_increasing_branch_and_bound(A); }, SIZE_MAX},
+    {"end to beginning", [](const sequence& A) { return longest_increasing_end_to_beginning(A); }, SIZE_MAX},
+    {"patience", [](const sequence& A) { return longest_increasing_patience(A); }, SIZE_MAX},
+    {"fast", [](const sequence& A) { return longest_increasing_fast(A); }, SIZE_MAX}
+  };
+}
+
+// Check every engine on input; returns a description of the first failure,
+// or an empty string when all engines agree.
+std::string differential_check(const sequence& input,
+                               const std::vector<lis_engine>& engines) {
+  std::vector<size_t> H;
+  const size_t expected = end_to_beginning_heights(input.begin(), input.size(), H,
+                                                   std::less<>(), identity_projection());
+
+  for (auto& engine : engines) {
+    if (input.size() > engine.max_size) {
+      continue;
+    }
+    const auto output = engine.solve(input);
+    std::string problem;
+    if (output.size() != expected) {
+      problem = "length " + std::to_string(output.size()) +
+                ", expected " + std::to_string(expected);
+    } else if (!is_increasing(output)) {
+      problem = "output not increasing";
+    } else if (!is_subsequence(output, input)) {
+      problem = "output not a subsequence";
+    }
+    if (!problem.empty()) {
+      return std::string(engine.name) + ": " + problem + ", output " + sequence_to_string(output);
+    }
+  }
+  return std::string();
+}
+
+// Shrink a failing input while it keeps failing: delete runs of elements,
+// halving the run length down to single elements, then make the values as
+// small as possible.
+sequence minimize_failure(sequence input, const std::vector<lis_engine>& engines) {
+  assert(!differential_check(input, engines).empty());
+  auto fails = [&](const sequence& candidate) {
+    return !differential_check(candidate, engines).empty();
+  };
+
+  for (size_t run = std::max<size_t>(input.size() / 2, 1); ; run /= 2) {
+    for (size_t i = 0; i < input.size(); ) {
+      sequence shorter(input.begin(), input.begin() + i);
+      shorter.insert(shorter.end(), input.begin() + std::min(i + run, input.size()), input.end());
+      if (fails(shorter)) {
+        input = std::move(shorter);
+      } else {
+        i += run;
+      }
+    }
+    if (run == 1) {
+      break;
+    }
+  }
+
+  // replace the values by their ranks, then lower each one while the
+  // failure persists
+  sequence values = input;
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  sequence ranked;
+  for (auto x : input) {
+    ranked.push_back(int(std::lower_bound(values.begin(), values.end(), x) - values.begin()));
+  }
+  if (fails(ranked)) {
+    input = std::move(ranked);
+  }
+  for (auto& x : input) {
+    while (x > 0) {
+      --x;
+      if (!fails(input)) {
+        ++x;
+        break;
+      }
+    }
+  }
+  return input;
+}
+
+struct differential_failure {
+  sequence input, minimized;
+  std::string problem;
+};
+
+struct differential_report {
+  size_t cases = 0;
+  std::vector<differential_failure> failures;
+};
+
+// Check cases random inputs of sizes 1 to max_size, in parallel on pool,
+// stopping after max_failures failures.
+differential_report run_differential(work_stealing_pool& pool,
+                                     const std::vector<lis_engine>& engines,
+                                     size_t cases, size_t max_size, unsigned seed,
+                                     size_t max_failures = 10) {
+  assert(max_size > 0);
+  differential_report report;
+  std::mutex mutex;
+  std::atomic<size_t> checked(0), failed(0);
+
+  pool.parallel_for(cases, 256, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i < end && failed.load(std::memory_order_relaxed) < max_failures; ++i) {
+      const size_t size = 1 + i % max_size;
+      const int max_element = (i / max_size) % 2 ? int(4 * size) : int(size / 2);
+      const auto input = random_sequence(size, unsigned(seed + i), max_element);
+      auto problem = differential_check(input, engines);
+      checked.fetch_add(1, std::memory_order_relaxed);
+      if (!problem.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (report.failures.size() < max_failures) {
+          report.failures.push_back({input, sequence(), problem});
+          failed.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    }
+  });
+
+  report.cases = checked.load();
+  for (auto& failure : report.failures) {
+    failure.minimized = minimize_failure(failure.input, engines);
+  }
+  return report;
+}
@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_dynamic.hpp
+//
+// Longest increasing subsequence length of a sequence that is edited in
+// place, one element at a time.
+//
+// No exact algorithm with polylogarithmic update time is known for this
+// problem, so dynamic_lis uses patience sorting with checkpoints. The state
+// of patience sorting after a prefix is just its tails array, and the
+// structure stores a copy of it at every block boundary. update(i, x) only
+// records the edit and marks its block dirty, in O(1). lis_length() then
+// replays patience sorting from the checkpoint before the first dirty block.
+// Whenever the replayed tails equal the stored checkpoint at a boundary, the
+// state there is as before the edits, so the replay jumps straight to the
+// next dirty block (or stops, if there is none). A local edit in random data
+// usually disturbs the tails for a short stretch only, so a query costs
+// roughly the blocks near the edits rather than a full recomputation.
+//
+// Bounds, for n elements, block size B and LIS length L:
+//
+//   update       O(1)
+//   lis_length   O(B log L + L) per replayed block. In the worst case an
+//                edit changes the tails from its block to the end (on sorted
+//                input, any edit that keeps the order does), and the query
+//                is a full O(n log L) replay, no better than recomputing.
+//   memory       O(n): the checkpoints hold at most
+//                DYNAMIC_LIS_CHECKPOINT_FACTOR * n elements in total. When
+//                they outgrow that (long tails, as on sorted input, would
+//                otherwise take O(n L / B)), the block size doubles and the
+//                checkpoints are rebuilt. B only grows, so this happens at
+//                most log2(n) times over the structure's life.
+//
+// The subsequence itself is recomputed on demand by witness().
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "lis_patience.hpp"
+#include "subsequence.hpp"
+#include "tails_search.hpp"
+
+// Default number of elements between two tails checkpoints.
+const size_t DYNAMIC_LIS_BLOCK = 1024;
+
+// Bound on the elements held by all checkpoints, per element of the sequence.
+const size_t DYNAMIC_LIS_CHECKPOINT_FACTOR = 2;
+
+template <typename T, typename Compare = std::less<>>
+class dynamic_lis {
+private:
+  using order = relation_order<Compare>;
+
+  std::vector<T> _values;
+  Compare _comp;
+  size_t _block;
+
+  // _checkpoints[c] is the tails array after the first c * _block elements,
+  // for every c with c * _block <= size().
+  std::vector<std::vector<T>> _checkpoints;
+  size_t _checkpoint_elements = 0;
+
+  // blocks edited since the last query, and a flag per block
+  std::vector<size_t> _dirty;
+  std::vector<char> _block_dirty;
+
+  size_t _length = 0;
+
+  // Place x in tails by patience sorting.
+  void place(std::vector<T>& tails, const T& x) const {
+    const size_t level = tails_search<order::strict>(tails.data(), tails.size(), x, order::of(_comp));
+    if (level == tails.size()) {
+      tails.push_back(x);
+    } else {
+      tails[level] = x;
+    }
+  }
+
+  // True when the checkpoints hold more elements than the budget allows.
+  bool over_budget() const {
+    return _checkpoint_elements > DYNAMIC_LIS_CHECKPOINT_FACTOR * _values.size();
+  }
+
+  // Replay patience sorting through the dirty blocks.
+  void refresh() {
+    std::sort(_dirty.begin(), _dirty.end());
+    auto next = _dirty.begin();
+    size_t c = *next;
+    std::vector<T> tails = _checkpoints[c];
+
+    while (true) {
+      while (next != _dirty.end() && *next <= c) {
+        ++next;
+      }
+      const size_t end = std::min((c + 1) * _block, _values.size());
+      for (size_t i = c * _block; i < end; ++i) {
+        place(tails, _values[i]);
+      }
+      if (end == _values.size()) {
+        _length = tails.size();
+        break;
+      }
+
+      ++c;
+      if (tails == _checkpoints[c]) {
+        // the state here is as before the edits
+        if (next == _dirty.end()) {
+          break;
+        }
+        c = *next;
+        tails = _checkpoints[c];
+      } else {
+        _checkpoint_elements += tails.size();
+        _checkpoint_elements -= _checkpoints[c].size();
+        _checkpoints[c] = tails;
+        if (over_budget()) {
+          rebuild(_block * 2);
+          return;
+        }
+      }
+    }
+
+    for (auto d : _dirty) {
+      _block_dirty[d] = false;
+    }
+    _dirty.clear();
+  }
+
+  // Recompute every checkpoint with at least the given block size. When the
+  // checkpoints outgrow the budget on the way, every other one is dropped
+  // and the block size doubles, so the budget holds throughout.
+  void rebuild(size_t block) {
+    _block = block;
+    _checkpoints.assign(_values.size() / _block + 1, std::vector<T>());
+    _checkpoint_elements = 0;
+
+    std::vector<T> tails;
+    for (size_t i = 0; i < _values.size(); ++i) {
+      place(tails, _values[i]);
+      if ((i + 1) % _block != 0) {
+        continue;
+      }
+      _checkpoints[(i + 1) / _block] = tails;
+      _checkpoint_elements += tails.size();
+      while (over_budget()) {
+        _block *= 2;
+        std::vector<std::vector<T>> kept(_values.size() / _block + 1);
+        _checkpoint_elements = 0;
+        for (size_t c = 1; c < kept.size(); ++c) {
+          kept[c].swap(_checkpoints[2 * c]);
+          _checkpoint_elements += kept[c].size();
+        }
+        _checkpoints.swap(kept);
+      }
+    }
+    _length = tails.size();
+
+    _block_dirty.assign(_checkpoints.size(), false);
+    _dirty.clear();
+  }
+
+public:
+
+  // Build the structure for the elements of [first, last), with a tails
+  // checkpoint every block elements.
+  template <typename InputIt>
+  dynamic_lis(InputIt first, InputIt last,
+              Compare comp = Compare(),
+              size_t block = DYNAMIC_LIS_BLOCK)
+    : _values(first, last), _comp(comp), _block(block) {
+    assert(block > 0);
+    rebuild(block);
+  }
+
+  template <typename Range>
+  explicit dynamic_lis(const Range& values,
+                       Compare comp = Compare(),
+                       size_t block = DYNAMIC_LIS_BLOCK)
+    : dynamic_lis(std::begin(values), std::end(values), comp, block) { }
+
+  size_t size() const {
+    return _values.size();
+  }
+
+  // Current number of elements between two checkpoints.
+  size_t block_size() const {
+    return _block;
+  }
+
+  // Elements held by all checkpoints together.
+  size_t checkpoint_elements() const {
+    return _checkpoint_elements;
+  }
+
+  const T& operator[](size_t i) const {
+    assert(i < size());
+    return _values[i];
+  }
+
+  // Set element i to x.
+  void update(size_t i, const T& x) {
+    assert(i < size());
+    _values[i] = x;
+    const size_t c = i / _block;
+    if (!_block_dirty[c]) {
+      _block_dirty[c] = true;
+      _dirty.push_back(c);
+    }
+  }
+
+  // Length of the longest increasing subsequence of the current values.
+  size_t lis_length() {
+    if (!_dirty.empty()) {
+      refresh();
+    }
+    return _length;
+  }
+
+  // A longest increasing subsequence of the current values, recomputed from
+  // scratch.
+  std::vector<T> witness() const {
+    return longest_increasing_patience(_values, _comp);
+  }
+};
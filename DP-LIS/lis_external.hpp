@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_external.hpp
+//
+// Longest increasing subsequence of a sequence stored in a raw binary file of
+// little-endian int32 or int64 values, for inputs that do not fit in memory.
+//
+// The file is read sequentially in fixed-size chunks and solved by patience
+// sorting, so RAM holds only the chunk buffer and the tails array (one value
+// and one index per LIS level). The predecessor of each element is spilled to
+// an anonymous temporary file as it is computed, 8 bytes per element, and the
+// subsequence is reconstructed at the end by following the predecessors
+// backwards with one seek per LIS element.
+//
+// I/O failures and truncated input are reported with std::runtime_error.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "tails_search.hpp"
+
+// Default number of elements read per chunk.
+const size_t EXTERNAL_LIS_CHUNK = 1 << 16;
+
+// Result of the external algorithm: the subsequence and the positions of its
+// elements in the file.
+template <typename T>
+struct external_lis_result {
+  std::vector<T> values;
+  std::vector<uint64_t> indices;
+
+  uint64_t length() const {
+    return values.size();
+  }
+};
+
+namespace external_lis_detail {
+
+  using file_ptr = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+  const uint64_t NO_PREDECESSOR = UINT64_MAX;
+
+  inline void seek(std::FILE* f, uint64_t offset) {
+#if defined(_WIN32)
+    int status = _fseeki64(f, static_cast<long long>(offset), SEEK_SET);
+#else
+    int status = fseeko(f, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    if (status != 0) {
+      throw std::runtime_error("external LIS: seek failed");
+    }
+  }
+
+  inline void read_exactly(std::FILE* f, void* buffer, size_t bytes) {
+    if (std::fread(buffer, 1, bytes, f) != bytes) {
+      throw std::runtime_error("external LIS: read failed");
+    }
+  }
+
+  // Decode one little-endian integer of type T, independent of host order.
+  template <typename T>
+  T decode(const unsigned char* bytes) {
+    typename std::make_unsigned<T>::type u = 0;
+    for (size_t b = sizeof(T); b-- > 0; ) {
+      u = (u << 8) | bytes[b];
+    }
+    return static_cast<T>(u);
+  }
+
+  template <typename T>
+  void encode(T x, unsigned char* bytes) {
+    auto u = static_cast<typename std::make_unsigned<T>::type>(x);
+    for (size_t b = 0; b < sizeof(T); ++b, u >>= 8) {
+      bytes[b] = static_cast<unsigned char>(u & 0xff);
+    }
+  }
+
+} // namespace external_lis_detail
+
+// Write values to path as raw little-endian integers of type T, the format
+// read by longest_increasing_external.
+template <typename T, typename Range>
+void write_raw_sequence(const std::string& path, const Range& values) {
+  static_assert(std::is_integral<T>::value, "raw sequences hold integers");
+  using namespace external_lis_detail;
+
+  file_ptr out(std::fopen(path.c_str(), "wb"), &std::fclose);
+  if (!out) {
+    throw std::runtime_error("external LIS: cannot create " + path);
+  }
+  std::vector<unsigned char> bytes;
+  bytes.reserve(EXTERNAL_LIS_CHUNK * sizeof(T));
+  unsigned char element[sizeof(T)];
+  for (auto& x : values) {
+    encode(static_cast<T>(x), element);
+    bytes.insert(bytes.end(), element, element + sizeof(T));
+    if (bytes.size() >= EXTERNAL_LIS_CHUNK * sizeof(T)) {
+      if (std::fwrite(bytes.data(), 1, bytes.size(), out.get()) != bytes.size()) {
+        throw std::runtime_error("external LIS: write failed");
+      }
+      bytes.clear();
+    }
+  }
+  if (std::fwrite(bytes.data(), 1, bytes.size(), out.get()) != bytes.size()) {
+    throw std::runtime_error("external LIS: write failed");
+  }
+}
+
+// Longest (strictly) increasing subsequence of the raw little-endian
+// sequence of T (int32_t or int64_t) stored in path, reading chunk elements
+// at a time.
+template <typename T>
+external_lis_result<T> longest_increasing_external(const std::string& path,
+                                                   size_t chunk = EXTERNAL_LIS_CHUNK) {
+  static_assert(std::is_same<T, int32_t>::value || std::is_same<T, int64_t>::value,
+                "external LIS reads int32 or int64 files");
+  using namespace external_lis_detail;
+
+  file_ptr in(std::fopen(path.c_str(), "rb"), &std::fclose);
+  if (!in) {
+    throw std::runtime_error("external LIS: cannot open " + path);
+  }
+  file_ptr spill(std::tmpfile(), &std::fclose);
+  if (!spill) {
+    throw std::runtime_error("external LIS: cannot create temporary file");
+  }
+
+  // tails[l] is the smallest value that ends an increasing subsequence of
+  // length l+1 so far, and tail_index[l] is its position.
+  std::vector<T> tails;
+  std::vector<uint64_t> tail_index;
+
+  std::vector<unsigned char> bytes(std::max<size_t>(chunk, 1) * sizeof(T));
+  std::vector<uint64_t> predecessors(bytes.size() / sizeof(T));
+
+  uint64_t index = 0;
+  while (true) {
+    const size_t got = std::fread(bytes.data(), 1, bytes.size(), in.get());
+    if (got % sizeof(T) != 0) {
+      throw std::runtime_error("external LIS: " + path + " is truncated");
+    }
+    const size_t count = got / sizeof(T);
+
+    for (size_t k = 0; k < count; ++k, ++index) {
+      const T x = decode<T>(&bytes[k * sizeof(T)]);
+      const size_t level = tails_search<true>(tails.data(), tails.size(), x, std::less<>());
+      predecessors[k] = level == 0 ? NO_PREDECESSOR : tail_index[level - 1];
+      if (level == tails.size()) {
+        tails.push_back(x);
+        tail_index.push_back(index);
+      } else {
+        tails[level] = x;
+        tail_index[level] = index;
+      }
+    }
+
+    if (std::fwrite(predecessors.data(), sizeof(uint64_t), count, spill.get()) != count) {
+      throw std::runtime_error("external LIS: write to temporary file failed");
+    }
+    if (got < bytes.size()) {
+      if (std::ferror(in.get())) {
+        throw std::runtime_error("external LIS: read failed");
+      }
+      break;
+    }
+  }
+
+  // follow the predecessors back from the last tail
+  external_lis_result<T> result;
+  const size_t length = tails.size();
+  result.values.resize(length);
+  result.indices.resize(length);
+  uint64_t at = length == 0 ? NO_PREDECESSOR : tail_index.back();
+  for (size_t k = length; k-- > 0; ) {
+    unsigned char element[sizeof(T)];
+    seek(in.get(), at * sizeof(T));
+    read_exactly(in.get(), element, sizeof(T));
+    result.values[k] = decode<T>(element);
+    result.indices[k] = at;
+
+    seek(spill.get(), at * sizeof(uint64_t));
+    read_exactly(spill.get(), &at, sizeof(uint64_t));
+  }
+
+  return result;
+}
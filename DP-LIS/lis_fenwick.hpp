@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_fenwick.hpp
+//
+// O(n log n) variants of the longest increasing subsequence problem built on
+// coordinate compression and a Fenwick (binary indexed) tree:
+//
+//  - heaviest_increasing_subsequence: the increasing subsequence with the
+//    largest total weight, for a weight given per element; and
+//  - count_longest_increasing: the length of the LIS and the number of
+//    distinct index sequences that attain it, as a 64-bit or modular count.
+//
+// Both sweep the input left to right. The values are first replaced by their
+// ranks among the distinct (projected) values, and the tree answers "best
+// over all ranks below r" for the elements seen so far, which is exactly the
+// set of possible predecessors of an element of rank r.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "subsequence.hpp"
+
+// Fenwick tree over count ranks that combines Node values with an
+// associative, commutative combine(a, b). update(r, x) merges x into rank r,
+// and query(count) returns the combination over ranks [0, count).
+template <typename Node, typename Combine>
+class prefix_fenwick {
+private:
+  std::vector<Node> _tree;
+  Node _identity;
+  Combine _combine;
+
+public:
+  prefix_fenwick(size_t count, const Node& identity, Combine combine = Combine())
+    : _tree(count + 1, identity), _identity(identity), _combine(combine) { }
+
+  void update(size_t rank, const Node& x) {
+    for (size_t i = rank + 1; i < _tree.size(); i += i & (0 - i)) {
+      _tree[i] = _combine(_tree[i], x);
+    }
+  }
+
+  Node query(size_t count) const {
+    assert(count < _tree.size());
+    Node result = _identity;
+    for (size_t i = count; i > 0; i -= i & (0 - i)) {
+      result = _combine(result, _tree[i]);
+    }
+    return result;
+  }
+};
+
+// Replace each projected element of A by its rank among the distinct
+// projected values under ordering, and return the number of distinct values.
+template <typename Range, typename Ordering, typename Projection>
+size_t compress_ranks(const Range& A, const Ordering& ordering,
+                      const Projection& proj, std::vector<size_t>& ranks) {
+  using key_type = typename std::decay<decltype(proj(*std::begin(A)))>::type;
+
+  std::vector<key_type> keys;
+  for (auto& x : A) {
+    keys.push_back(proj(x));
+  }
+  std::vector<key_type> distinct(keys);
+  std::sort(distinct.begin(), distinct.end(), ordering);
+  distinct.erase(std::unique(distinct.begin(), distinct.end(),
+                             [&](const key_type& a, const key_type& b) {
+                               return !ordering(a, b) && !ordering(b, a);
+                             }),
+                 distinct.end());
+
+  ranks.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ranks[i] = std::lower_bound(distinct.begin(), distinct.end(), keys[i], ordering)
+               - distinct.begin();
+  }
+  return distinct.size();
+}
+
+// Result of heaviest_increasing_subsequence.
+template <typename T, typename W>
+struct weighted_lis_result {
+  W weight;
+  std::vector<T> values;
+  std::vector<size_t> indices;
+};
+
+// The increasing subsequence of A whose weights (weights[i] belongs to A[i])
+// have the largest sum. Elements with negative weight are only taken when
+// they lead to heavier elements; if every weight is negative the result is
+// empty with weight 0.
+template <typename Range,
+          typename Weights,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+auto heaviest_increasing_subsequence(const Range& A, const Weights& weights,
+                                     Compare comp = Compare(),
+                                     Projection proj = Projection()) {
+  using value_type = typename std::decay<decltype(*std::begin(A))>::type;
+  using weight_type = typename std::decay<decltype(*std::begin(weights))>::type;
+  using order = relation_order<Compare>;
+
+  const size_t NONE = size_t(-1);
+
+  std::vector<size_t> ranks;
+  const size_t distinct = compress_ranks(A, order::of(comp), proj, ranks);
+  const size_t n = ranks.size();
+  assert(size_t(std::distance(std::begin(weights), std::end(weights))) == n);
+
+  // best chain weight ending at some element, and that element
+  struct node {
+    weight_type weight;
+    size_t index;
+  };
+  auto heavier = [](const node& a, const node& b) {
+    return b.weight > a.weight ? b : a;
+  };
+  prefix_fenwick<node, decltype(heavier)> tree(distinct, node{weight_type(0), NONE}, heavier);
+
+  std::vector<weight_type> chain(n);
+  std::vector<size_t> predecessor(n);
+  node best{weight_type(0), NONE};
+
+  auto w = std::begin(weights);
+  for (size_t i = 0; i < n; ++i, ++w) {
+    const node before = tree.query(order::strict ? ranks[i] : ranks[i] + 1);
+    chain[i] = before.weight + *w;
+    predecessor[i] = before.index;
+    tree.update(ranks[i], node{chain[i], i});
+    if (chain[i] > best.weight) {
+      best = node{chain[i], i};
+    }
+  }
+
+  weighted_lis_result<value_type, weight_type> result;
+  result.weight = best.weight;
+  for (size_t i = best.index; i != NONE; i = predecessor[i]) {
+    result.indices.push_back(i);
+  }
+  std::reverse(result.indices.begin(), result.indices.end());
+  auto next = result.indices.begin();
+  size_t i = 0;
+  for (auto& x : A) {
+    if (next != result.indices.end() && *next == i++) {
+      result.values.push_back(x);
+      ++next;
+    }
+  }
+  return result;
+}
+
+// Result of count_longest_increasing.
+struct lis_count_result {
+  size_t length;
+  uint64_t count;
+};
+
+// Length of the longest increasing subsequence of A and the number of
+// distinct index sequences of that length that are increasing. When modulus
+// is 0 the count wraps modulo 2^64; otherwise it is reduced modulo modulus.
+// An empty A has a single, empty, longest subsequence.
+template <typename Range,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+lis_count_result count_longest_increasing(const Range& A,
+                                          uint64_t modulus = 0,
+                                          Compare comp = Compare(),
+                                          Projection proj = Projection()) {
+  using order = relation_order<Compare>;
+
+  auto add = [modulus](uint64_t a, uint64_t b) {
+    uint64_t sum = a + b;
+    if (modulus != 0 && (sum < a || sum >= modulus)) {
+      sum -= modulus;
+    }
+    return sum;
+  };
+
+  // length of the longest chain ending at some element, and the number of
+  // such chains
+  struct node {
+    size_t length;
+    uint64_t count;
+  };
+  auto longer = [add](const node& a, const node& b) {
+    if (a.length != b.length) {
+      return a.length > b.length ? a : b;
+    }
+    return node{a.length, add(a.count, b.count)};
+  };
+
+  std::vector<size_t> ranks;
+  const size_t distinct = compress_ranks(A, order::of(comp), proj, ranks);
+  prefix_fenwick<node, decltype(longer)> tree(distinct, node{0, 0}, longer);
+
+  const uint64_t one = modulus == 1 ? 0 : 1;
+  node total{0, 0};
+  for (auto r : ranks) {
+    node before = tree.query(order::strict ? r : r + 1);
+    const node here = before.length == 0 ? node{1, one}
+                                          : node{before.length + 1, before.count};
+    tree.update(r, here);
+    total = longer(total, here);
+  }
+
+  return lis_count_result{total.length, total.length == 0 ? one : total.count};
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_patience.hpp
+//
+// O(n log n) patience sorting algorithm for the longest increasing
+// subsequence problem, the general-purpose fast engine.
+//
+// tails[l] holds the smallest key that ends an increasing subsequence of
+// length l+1 among the elements seen so far; tails is sorted, so each new
+// element searches for the first tail it can replace (or extends tails),
+// using the branch-free kernels of tails_search.hpp. Remembering, for every
+// element, the element that ended the previous level when it was placed
+// gives a predecessor chain from which the subsequence is rebuilt.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "subsequence.hpp"
+#include "tails_search.hpp"
+
+// Longest increasing subsequence of [first, last) under the same relation and
+// projection conventions as longest_increasing_end_to_beginning. The length
+// always matches the DP; when several subsequences are longest, the one
+// returned may differ.
+template <typename RandomIt,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+std::vector<typename std::iterator_traits<RandomIt>::value_type>
+longest_increasing_patience(RandomIt A, RandomIt last,
+                            Compare comp = Compare(),
+                            Projection proj = Projection()) {
+
+  using order = relation_order<Compare>;
+  using key_type = typename std::decay<decltype(proj(*A))>::type;
+
+  const size_t n = last - A;
+  const size_t NONE = size_t(-1);
+  const auto& ordering = order::of(comp);
+
+  std::vector<key_type> tails;
+  std::vector<size_t> tail_index, predecessor(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    const key_type key = proj(A[i]);
+    // strict: replace the first tail >= key; non-strict: the first tail > key
+    const size_t level = tails_search<order::strict>(tails.data(), tails.size(), key, ordering);
+
+    predecessor[i] = level == 0 ? NONE : tail_index[level - 1];
+    if (level == tails.size()) {
+      tails.push_back(key);
+      tail_index.push_back(i);
+    } else {
+      tails[level] = key;
+      tail_index[level] = i;
+    }
+  }
+
+  std::vector<typename std::iterator_traits<RandomIt>::value_type> R(tails.size());
+  size_t at = tails.empty() ? NONE : tail_index.back();
+  for (size_t k = R.size(); k-- > 0; at = predecessor[at]) {
+    R[k] = A[at];
+  }
+  return R;
+}
+
+template <typename Range,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+auto longest_increasing_patience(const Range& A,
+                                 Compare comp = Compare(),
+                                 Projection proj = Projection()) {
+  using std::begin;
+  using std::end;
+  return longest_increasing_patience(begin(A), end(A), comp, proj);
+}
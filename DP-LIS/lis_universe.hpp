@@ -0,0 +1,287 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_universe.hpp
+//
+// Longest increasing subsequence for integer values drawn from a small range
+// [lo, hi], such as the output of random_sequence.
+//
+// In patience sorting the tails are strictly increasing, so for strict LIS
+// they form a set of distinct values. Instead of a sorted array we keep that
+// set as a hierarchical bitset over the universe U = hi - lo + 1: placing a
+// value x removes the successor of x (the smallest tail >= x), if any, and
+// inserts x, and the predecessor of x (the largest tail < x) ends the chain
+// x extends. Each successor or predecessor query walks O(log_64 U) words,
+// at most four for U up to 2^24, using bit scans instead of branchy
+// comparisons.
+//
+// longest_increasing_fast picks this engine when the keys are integers under
+// the natural strict order and their range is small, and falls back to
+// longest_increasing_patience otherwise.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "lis_patience.hpp"
+#include "subsequence.hpp"
+
+// Largest universe handled by the small-universe engine.
+const size_t SMALL_UNIVERSE_LIMIT = size_t(1) << 24;
+
+// The universe must also be at most this many times the input size, so that
+// clearing the per-value arrays never dominates the run time.
+const size_t SMALL_UNIVERSE_PER_ELEMENT = 4;
+
+// Set of integers in [0, universe) supporting insert, erase and
+// successor/predecessor queries. Level 0 has one bit per value; each word of
+// level k+1 summarizes 64 words of level k, with a bit set when that word is
+// nonzero.
+class successor_bitset {
+private:
+  std::vector<std::vector<uint64_t>> _levels;
+  size_t _universe;
+
+  static unsigned lowest_bit(uint64_t w) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(w);
+#else
+    unsigned b = 0;
+    while (!(w & 1)) { w >>= 1; ++b; }
+    return b;
+#endif
+  }
+
+  static unsigned highest_bit(uint64_t w) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(w);
+#else
+    unsigned b = 63;
+    while (!(w >> 63)) { w <<= 1; --b; }
+    return b;
+#endif
+  }
+
+public:
+  static const size_t NONE = size_t(-1);
+
+  explicit successor_bitset(size_t universe)
+    : _universe(universe) {
+    size_t words = std::max<size_t>(1, (universe + 63) / 64);
+    _levels.emplace_back(words, 0);
+    while (words > 1) {
+      words = (words + 63) / 64;
+      _levels.emplace_back(words, 0);
+    }
+  }
+
+  size_t universe() const {
+    return _universe;
+  }
+
+  bool contains(size_t x) const {
+    assert(x < _universe);
+    return (_levels[0][x >> 6] >> (x & 63)) & 1;
+  }
+
+  void insert(size_t x) {
+    assert(x < _universe);
+    for (auto& level : _levels) {
+      uint64_t& word = level[x >> 6];
+      const bool was_empty = word == 0;
+      word |= uint64_t(1) << (x & 63);
+      if (!was_empty) {
+        break;
+      }
+      x >>= 6;
+    }
+  }
+
+  void erase(size_t x) {
+    assert(x < _universe);
+    for (auto& level : _levels) {
+      uint64_t& word = level[x >> 6];
+      word &= ~(uint64_t(1) << (x & 63));
+      if (word != 0) {
+        break;
+      }
+      x >>= 6;
+    }
+  }
+
+  // Smallest member >= x, or NONE.
+  size_t successor(size_t x) const {
+    const size_t top = _levels.size();
+    size_t level = 0, i = x;
+    while (true) {
+      const size_t w = i >> 6;
+      if (w >= _levels[level].size()) {
+        return NONE;
+      }
+      const uint64_t bits = _levels[level][w] & (~uint64_t(0) << (i & 63));
+      if (bits) {
+        i = (w << 6) | lowest_bit(bits);
+        break;
+      }
+      i = w + 1;
+      if (++level == top) {
+        return NONE;
+      }
+    }
+    while (level-- > 0) {
+      i = (i << 6) | lowest_bit(_levels[level][i]);
+    }
+    return i;
+  }
+
+  // Largest member < x, or NONE. x may equal universe().
+  size_t predecessor(size_t x) const {
+    if (x == 0) {
+      return NONE;
+    }
+    const size_t top = _levels.size();
+    size_t level = 0, i = x - 1;
+    while (true) {
+      const size_t w = i >> 6;
+      const uint64_t bits = _levels[level][w] & (~uint64_t(0) >> (63 - (i & 63)));
+      if (bits) {
+        i = (w << 6) | highest_bit(bits);
+        break;
+      }
+      if (w == 0 || ++level == top) {
+        return NONE;
+      }
+      i = w - 1;
+    }
+    while (level-- > 0) {
+      i = (i << 6) | highest_bit(_levels[level][i]);
+    }
+    return i;
+  }
+};
+
+// Longest strictly increasing subsequence of [first, last), whose projected
+// keys must all lie in [lo, hi] with hi - lo < SMALL_UNIVERSE_LIMIT.
+template <typename RandomIt,
+          typename Key,
+          typename Projection = identity_projection>
+std::vector<typename std::iterator_traits<RandomIt>::value_type>
+longest_increasing_small_universe(RandomIt A, RandomIt last, Key lo, Key hi,
+                                  Projection proj = Projection()) {
+  static_assert(std::is_integral<Key>::value, "small-universe keys are integers");
+  assert(lo <= hi);
+
+  const size_t n = last - A;
+  const size_t NONE = successor_bitset::NONE;
+  const size_t universe = size_t(hi - lo) + 1;
+  assert(universe <= SMALL_UNIVERSE_LIMIT);
+
+  successor_bitset tails(universe);
+  // tail_index[v] is the element currently ending the level whose tail is v
+  std::vector<size_t> tail_index(universe);
+  std::vector<size_t> predecessor(n);
+  size_t length = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    const Key key = proj(A[i]);
+    assert(lo <= key && key <= hi);
+    const size_t v = size_t(key - lo);
+
+    const size_t replaced = tails.successor(v);
+    if (replaced == NONE) {
+      ++length;
+    } else {
+      tails.erase(replaced);
+    }
+    const size_t before = tails.predecessor(v);
+    predecessor[i] = before == NONE ? NONE : tail_index[before];
+    tails.insert(v);
+    tail_index[v] = i;
+  }
+
+  std::vector<typename std::iterator_traits<RandomIt>::value_type> R(length);
+  size_t at = length == 0 ? NONE : tail_index[tails.predecessor(universe)];
+  for (size_t k = length; k-- > 0; at = predecessor[at]) {
+    R[k] = A[at];
+  }
+  return R;
+}
+
+// True for the orderings that compare integer keys by their natural order.
+template <typename Ordering, typename Key>
+struct is_natural_less : std::false_type { };
+
+template <typename Key>
+struct is_natural_less<std::less<>, Key> : std::true_type { };
+
+template <typename Key>
+struct is_natural_less<std::less<Key>, Key> : std::true_type { };
+
+// Dispatch for longest_increasing_fast: integer keys under strict natural
+// order may take the small-universe engine...
+template <typename RandomIt, typename Compare, typename Projection>
+std::vector<typename std::iterator_traits<RandomIt>::value_type>
+longest_increasing_fast_dispatch(RandomIt A, RandomIt last, Compare comp,
+                                 Projection proj, std::true_type) {
+  if (A == last) {
+    return {};
+  }
+  auto lo = proj(*A), hi = lo;
+  for (RandomIt it = A; it != last; ++it) {
+    const auto key = proj(*it);
+    lo = std::min(lo, key);
+    hi = std::max(hi, key);
+  }
+  // compare in the unsigned domain so that a full-width range cannot overflow
+  using unsigned_key = typename std::make_unsigned<decltype(lo)>::type;
+  const auto span = unsigned_key(unsigned_key(hi) - unsigned_key(lo));
+  const size_t n = last - A;
+  if (span < SMALL_UNIVERSE_LIMIT && span < SMALL_UNIVERSE_PER_ELEMENT * n) {
+    return longest_increasing_small_universe(A, last, lo, hi, proj);
+  }
+  return longest_increasing_patience(A, last, comp, proj);
+}
+
+// ...and everything else goes to the general engine.
+template <typename RandomIt, typename Compare, typename Projection>
+std::vector<typename std::iterator_traits<RandomIt>::value_type>
+longest_increasing_fast_dispatch(RandomIt A, RandomIt last, Compare comp,
+                                 Projection proj, std::false_type) {
+  return longest_increasing_patience(A, last, comp, proj);
+}
+
+// Longest increasing subsequence of [first, last) using the fastest engine
+// that applies: the small-universe engine when the keys are integers in a
+// small range under strict natural order, and longest_increasing_patience
+// otherwise.
+template <typename RandomIt,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+std::vector<typename std::iterator_traits<RandomIt>::value_type>
+longest_increasing_fast(RandomIt A, RandomIt last,
+                        Compare comp = Compare(),
+                        Projection proj = Projection()) {
+  using key_type = typename std::decay<decltype(proj(*A))>::type;
+  using small = std::integral_constant<bool,
+    std::is_integral<key_type>::value && relation_order<Compare>::strict &&
+    is_natural_less<Compare, key_type>::value>;
+  return longest_increasing_fast_dispatch(A, last, comp, proj, small());
+}
+
+template <typename Range,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+auto longest_increasing_fast(const Range& A,
+                             Compare comp = Compare(),
+                             Projection proj = Projection()) {
+  using std::begin;
+  using std::end;
+  return longest_increasing_fast(begin(A), end(A), comp, proj);
+}
@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_window.hpp
+//
+// Longest increasing subsequence of every window of the last k values of a
+// stream, in O(k) time per value instead of recomputing each window.
+//
+// For each position i of the current window we keep the same value H[i]
+// that longest_increasing_end_to_beginning computes for the window: H[i] + 1
+// is the length of the longest increasing subsequence that starts at i.
+// H[i] only counts elements after i, so dropping the oldest value leaves
+// every other H unchanged. Appending a value x can raise each H[i] by at most
+// one, and it does so exactly when some j > i with A[i] < A[j] and
+// H[j] == H[i] - 1 was itself raised (x counts as raised, at height -1).
+// Scanning the window from newest to oldest while remembering, for each
+// height, the largest raised element seen so far decides every i in O(1).
+//
+// Because the heights are exactly those of the DP, the witness for a window
+// is traced the same way and equals longest_increasing_end_to_beginning of
+// that window.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "subsequence.hpp"
+
+template <typename T,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+class sliding_window_lis {
+private:
+  static const size_t NONE = size_t(-1);
+
+  size_t _k;
+  Compare _comp;
+  Projection _proj;
+
+  // The window occupies [_begin, _begin + _size) of _values and _H. Both
+  // buffers hold 2k entries, and the window is moved back to the front when
+  // it reaches the end, so each value is moved at most once on average.
+  std::vector<T> _values;
+  std::vector<size_t> _H;
+  size_t _begin = 0, _size = 0;
+
+  // _best[h] is the position of the largest element raised from height h-1
+  // during the current scan, or NONE.
+  std::vector<size_t> _best;
+
+  size_t _length = 0;
+
+public:
+
+  // Create an empty window of capacity k, which must be positive.
+  explicit sliding_window_lis(size_t k,
+                              Compare comp = Compare(),
+                              Projection proj = Projection())
+    : _k(k), _comp(comp), _proj(proj),
+      _values(2 * k), _H(2 * k), _best(k + 1, NONE) {
+    assert(k > 0);
+  }
+
+  size_t capacity() const {
+    return _k;
+  }
+
+  // Number of values currently in the window, at most capacity().
+  size_t size() const {
+    return _size;
+  }
+
+  bool full() const {
+    return _size == _k;
+  }
+
+  // Length of the longest increasing subsequence of the window.
+  size_t length() const {
+    return _length;
+  }
+
+  // Append x, dropping the oldest value if the window is full, and return
+  // the new length().
+  size_t push(const T& x) {
+
+    if (_size == _k) {
+      ++_begin;
+      --_size;
+    }
+    if (_begin + _size == _values.size()) {
+      std::move(_values.begin() + _begin, _values.begin() + _begin + _size, _values.begin());
+      std::move(_H.begin() + _begin, _H.begin() + _begin + _size, _H.begin());
+      _begin = 0;
+    }
+
+    const size_t e = _begin + _size;
+    _values[e] = x;
+    _H[e] = 0;
+    ++_size;
+
+    // heights in the old window are below _length, so only that many
+    // levels can be touched by this scan
+    std::fill(_best.begin(), _best.begin() + _length + 1, NONE);
+    _best[0] = e;
+
+    size_t max = 1;
+    for (size_t i = e; i-- > _begin; ) {
+      const size_t h = _H[i];
+      const size_t j = _best[h];
+      if (j != NONE && _comp(_proj(_values[i]), _proj(_values[j]))) {
+        size_t& best = _best[h + 1];
+        if (best == NONE || _comp(_proj(_values[best]), _proj(_values[i]))) {
+          best = i;
+        }
+        _H[i] = h + 1;
+      }
+      max = std::max(max, _H[i] + 1);
+    }
+
+    _length = max;
+    return _length;
+  }
+
+  // The longest increasing subsequence of the window, identical to
+  // longest_increasing_end_to_beginning of the window's values.
+  std::vector<T> witness() const {
+    std::vector<T> R;
+    R.reserve(_length);
+    end_to_beginning_trace(_values.begin() + _begin, _size,
+                           _H.begin() + _begin, _length,
+                           std::back_inserter(R));
+    return R;
+  }
+};
+
+template <typename T, typename Compare, typename Projection>
+const size_t sliding_window_lis<T, Compare, Projection>::NONE;
+
+// Return the LIS length of every window of k consecutive elements of
+// [first, last), in window order. If there are fewer than k elements there
+// are no windows and the result is empty.
+template <typename InputIt,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+std::vector<size_t> longest_increasing_windows(InputIt first, InputIt last,
+                                               size_t k,
+                                               Compare comp = Compare(),
+                                               Projection proj = Projection()) {
+  using value_type = typename std::iterator_traits<InputIt>::value_type;
+
+  sliding_window_lis<value_type, Compare, Projection> window(k, comp, proj);
+  std::vector<size_t> lengths;
+  for (; first != last; ++first) {
+    window.push(*first);
+    if (window.full()) {
+      lengths.push_back(window.length());
+    }
+  }
+  return lengths;
+}
+
+template <typename Range,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+std::vector<size_t> longest_increasing_windows(const Range& A, size_t k,
+                                               Compare comp = Compare(),
+                                               Projection proj = Projection()) {
+  using std::begin;
+  using std::end;
+  return longest_increasing_windows(begin(A), end(A), k, comp, proj);
+}
+
+// As above, and also store the witness subsequence of each window whose
+// position is listed in selected (window t covers elements [t, t + k)).
+// selected must be sorted; witnesses receives one entry per position.
+template <typename Range,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+std::vector<size_t> longest_increasing_windows(
+    const Range& A, size_t k,
+    const std::vector<size_t>& selected,
+    std::vector<std::vector<typename Range::value_type>>& witnesses,
+    Compare comp = Compare(),
+    Projection proj = Projection()) {
+
+  assert(std::is_sorted(selected.begin(), selected.end()));
+
+  sliding_window_lis<typename Range::value_type, Compare, Projection>
+    window(k, comp, proj);
+  std::vector<size_t> lengths;
+  witnesses.clear();
+  auto next = selected.begin();
+  for (auto& x : A) {
+    window.push(x);
+    if (window.full()) {
+      for (; next != selected.end() && *next == lengths.size(); ++next) {
+        witnesses.push_back(window.witness());
+      }
+      lengths.push_back(window.length());
+    }
+  }
+  return lengths;
+}
@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////////
+// sequence_generators.hpp
+//
+// Counter-based generators of benchmark input sequences.
+//
+// Unlike random_sequence, which draws from one serial std::mt19937 stream,
+// every generator here computes element i directly from (seed, i) with the
+// SplitMix64 mixing function. Any index range can therefore be filled on its
+// own, a large sequence is filled in parallel on a work_stealing_pool, and the
+// output for a given seed is bit-identical whatever the number of threads.
+// The per-element work is a few multiplies and shifts with no loop-carried
+// state, so the fill loops are also left to the compiler to vectorize.
+//
+// Values are mapped to [0, max_element] by taking the high 32 bits of the
+// hash and scaling with a multiply and shift; the bias this leaves is below
+// (max_element + 1) / 2^32, which is negligible for benchmark inputs.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "subsequence.hpp"
+#include "work_stealing_pool.hpp"
+
+// Number of elements filled per parallel work item.
+const size_t GENERATOR_GRAIN = 1 << 16;
+
+// SplitMix64 output for the given counter under the given seed: element i of
+// the SplitMix64 stream started at seed.
+inline uint64_t splitmix64(uint64_t seed, uint64_t counter) {
+  uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// Scale a 64-bit hash to [0, max_element].
+inline int scale_to_range(uint64_t hash, int max_element) {
+  return int(((hash >> 32) * (uint64_t(max_element) + 1)) >> 32);
+}
+
+// Uniform values in [0, max_element].
+struct uniform_generator {
+  uint64_t seed;
+  int max_element;
+
+  int operator()(uint64_t i) const {
+    return scale_to_range(splitmix64(seed, i), max_element);
+  }
+};
+
+// Non-decreasing values spread evenly from 0 to max_element over size
+// elements.
+struct sorted_generator {
+  uint64_t size;
+  int max_element;
+
+  int operator()(uint64_t i) const {
+    return size <= 1 ? 0 : int(i * uint64_t(max_element) / (size - 1));
+  }
+};
+
+// The sorted sequence reversed: non-increasing from max_element to 0.
+struct reverse_sorted_generator {
+  uint64_t size;
+  int max_element;
+
+  int operator()(uint64_t i) const {
+    return max_element - sorted_generator{size, max_element}(i);
+  }
+};
+
+// The sorted sequence with each element independently replaced by a uniform
+// value with probability disorder / 2^32.
+struct nearly_sorted_generator {
+  uint64_t size;
+  uint64_t seed;
+  int max_element;
+  uint32_t disorder;
+
+  int operator()(uint64_t i) const {
+    const uint64_t hash = splitmix64(seed, i);
+    return uint32_t(hash) < disorder
+      ? scale_to_range(hash, max_element)
+      : sorted_generator{size, max_element}(i);
+  }
+};
+
+// Runs of plateau_length equal values, each run at an independent uniform
+// height in [0, max_element].
+struct plateau_generator {
+  uint64_t seed;
+  int max_element;
+  uint64_t plateau_length;
+
+  int operator()(uint64_t i) const {
+    return scale_to_range(splitmix64(seed, i / plateau_length), max_element);
+  }
+};
+
+// Fill out[0 .. end - begin) with elements [begin, end) of gen.
+template <typename Generator>
+void fill_sequence(int* out, uint64_t begin, uint64_t end, const Generator& gen) {
+  for (uint64_t i = begin; i < end; ++i) {
+    out[i - begin] = gen(i);
+  }
+}
+
+// Generate elements [0, size) of gen in parallel on pool.
+template <typename Generator>
+sequence generate_sequence(size_t size, const Generator& gen,
+                           work_stealing_pool& pool) {
+  // sequence is a std::vector<int>, which cannot be sized without
+  // value-initializing its elements. The serial zero-fill is accepted: it is
+  // a single memset, cheaper than the generators' per-element hashing, and
+  // an uninitialized buffer would have to be copied into the vector anyway.
+  sequence result(size);
+  int* out = result.data();
+  pool.parallel_for(size, GENERATOR_GRAIN,
+                    [&](unsigned, size_t begin, size_t end) {
+    fill_sequence(out + begin, begin, end, gen);
+  });
+  return result;
+}
+
+// Counter-based counterpart of random_sequence: size uniform values in
+// [0, max_element]. max_element must be non-negative.
+sequence counter_random_sequence(size_t size, uint64_t seed, int max_element,
+                                 work_stealing_pool& pool) {
+  assert(max_element >= 0);
+  return generate_sequence(size, uniform_generator{seed, max_element}, pool);
+}
+
+sequence sorted_sequence(size_t size, int max_element,
+                         work_stealing_pool& pool) {
+  assert(max_element >= 0);
+  return generate_sequence(size, sorted_generator{size, max_element}, pool);
+}
+
+sequence reverse_sorted_sequence(size_t size, int max_element,
+                                 work_stealing_pool& pool) {
+  assert(max_element >= 0);
+  return generate_sequence(size, reverse_sorted_generator{size, max_element}, pool);
+}
+
+// A sorted sequence with about fraction * size elements replaced by uniform
+// values. fraction must be in [0, 1].
+sequence nearly_sorted_sequence(size_t size, uint64_t seed, int max_element,
+                                double fraction, work_stealing_pool& pool) {
+  assert(max_element >= 0);
+  assert(0.0 <= fraction && fraction <= 1.0);
+  const uint32_t disorder = fraction >= 1.0 ? UINT32_MAX : uint32_t(fraction * 4294967296.0);
+  return generate_sequence(size, nearly_sorted_generator{size, seed, max_element, disorder}, pool);
+}
+
+sequence plateau_sequence(size_t size, uint64_t seed, int max_element,
+                          size_t plateau_length, work_stealing_pool& pool) {
+  assert(max_element >= 0);
+  assert(plateau_length > 0);
+  return generate_sequence(size, plateau_generator{seed, max_element, plateau_length}, pool);
+}
@@ -0,0 +1,268 @@
+///////////////////////////////////////////////////////////////////////////////
+// sequence_io.hpp
+//
+// Reading and writing sequences to files, in a compact binary format or as
+// text.
+//
+// Binary format (all integers little-endian):
+//
+//    offset  size  field
+//         0     4  magic "LISQ"
+//         4     2  version, currently 1
+//         6     2  encoding: 0 = raw, 1 = delta varint
+//         8     8  element count
+//        16        payload
+//
+// The raw payload is one int32 per element. The delta varint payload stores
+// each element as the difference from the previous one (the first from 0),
+// zigzag-mapped to an unsigned value and written in LEB128 groups of 7 bits,
+// so slowly varying or sorted sequences take one or two bytes per element.
+//
+// Text files hold decimal integers separated by whitespace and/or commas,
+// optionally enclosed in brackets, so the output of sequence_to_string reads
+// back unchanged. Text is formatted with append_decimal and parsed by hand
+// (std::to_chars and std::from_chars are C++17), and every file is moved in
+// one buffered read or write.
+//
+// I/O failures and malformed input are reported with std::runtime_error.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "subsequence.hpp"
+
+enum sequence_encoding {
+  SEQUENCE_RAW = 0,
+  SEQUENCE_DELTA_VARINT = 1
+};
+
+const char SEQUENCE_MAGIC[4] = {'L', 'I', 'S', 'Q'};
+const uint16_t SEQUENCE_VERSION = 1;
+const size_t SEQUENCE_HEADER_SIZE = 16;
+
+namespace sequence_io_detail {
+
+  using file_ptr = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+  inline void put_le(std::vector<unsigned char>& out, uint64_t x, size_t bytes) {
+    for (size_t b = 0; b < bytes; ++b, x >>= 8) {
+      out.push_back(static_cast<unsigned char>(x & 0xff));
+    }
+  }
+
+  inline uint64_t get_le(const unsigned char* in, size_t bytes) {
+    uint64_t x = 0;
+    for (size_t b = bytes; b-- > 0; ) {
+      x = (x << 8) | in[b];
+    }
+    return x;
+  }
+
+  // True for the characters that may separate the integers of a text file.
+  inline bool is_separator(char c) {
+    return c == ' ' || c == ',' || c == '\n' || c == '\t' || c == '\r' ||
+           c == '[' || c == ']';
+  }
+
+  inline std::vector<unsigned char> read_file(const std::string& path) {
+    file_ptr in(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!in) {
+      throw std::runtime_error("sequence I/O: cannot open " + path);
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char buffer[1 << 16];
+    size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), in.get())) > 0) {
+      bytes.insert(bytes.end(), buffer, buffer + got);
+    }
+    if (std::ferror(in.get())) {
+      throw std::runtime_error("sequence I/O: cannot read " + path);
+    }
+    return bytes;
+  }
+
+  inline void write_file(const std::string& path, const void* data, size_t size) {
+    file_ptr out(std::fopen(path.c_str(), "wb"), &std::fclose);
+    if (!out || std::fwrite(data, 1, size, out.get()) != size ||
+        std::fflush(out.get()) != 0) {
+      throw std::runtime_error("sequence I/O: cannot write " + path);
+    }
+  }
+
+} // namespace sequence_io_detail
+
+// Serialize seq in the binary format with the given encoding.
+std::vector<unsigned char> encode_sequence(const sequence& seq,
+                                           sequence_encoding encoding = SEQUENCE_RAW) {
+  using namespace sequence_io_detail;
+
+  std::vector<unsigned char> out;
+  out.reserve(SEQUENCE_HEADER_SIZE + seq.size() * 4);
+  for (auto c : SEQUENCE_MAGIC) {
+    out.push_back(static_cast<unsigned char>(c));
+  }
+  put_le(out, SEQUENCE_VERSION, 2);
+  put_le(out, encoding, 2);
+  put_le(out, seq.size(), 8);
+
+  if (encoding == SEQUENCE_RAW) {
+    for (auto x : seq) {
+      put_le(out, static_cast<uint32_t>(x), 4);
+    }
+  } else {
+    int64_t previous = 0;
+    for (auto x : seq) {
+      const int64_t delta = x - previous;
+      previous = x;
+      uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+      while (zigzag >= 0x80) {
+        out.push_back(static_cast<unsigned char>(zigzag | 0x80));
+        zigzag >>= 7;
+      }
+      out.push_back(static_cast<unsigned char>(zigzag));
+    }
+  }
+  return out;
+}
+
+// True when the size bytes at data start with the binary format's magic.
+bool is_binary_sequence(const unsigned char* data, size_t size) {
+  return size >= SEQUENCE_HEADER_SIZE && std::memcmp(data, SEQUENCE_MAGIC, 4) == 0;
+}
+
+// Deserialize a sequence in the binary format.
+sequence decode_sequence(const unsigned char* data, size_t size) {
+  using namespace sequence_io_detail;
+
+  if (!is_binary_sequence(data, size)) {
+    throw std::runtime_error("sequence I/O: not a binary sequence");
+  }
+  if (get_le(data + 4, 2) != SEQUENCE_VERSION) {
+    throw std::runtime_error("sequence I/O: unsupported version");
+  }
+  const uint64_t encoding = get_le(data + 6, 2);
+  const uint64_t count = get_le(data + 8, 8);
+  const unsigned char* p = data + SEQUENCE_HEADER_SIZE;
+  const unsigned char* end = data + size;
+
+  sequence seq;
+  if (encoding == SEQUENCE_RAW) {
+    if (uint64_t(end - p) / 4 < count) {
+      throw std::runtime_error("sequence I/O: truncated raw payload");
+    }
+    seq.resize(count);
+    for (auto& x : seq) {
+      x = static_cast<int32_t>(static_cast<uint32_t>(get_le(p, 4)));
+      p += 4;
+    }
+  } else if (encoding == SEQUENCE_DELTA_VARINT) {
+    // every element takes at least one byte
+    if (uint64_t(end - p) < count) {
+      throw std::runtime_error("sequence I/O: truncated varint payload");
+    }
+    seq.resize(count);
+    int64_t previous = 0;
+    for (auto& x : seq) {
+      uint64_t zigzag = 0;
+      for (unsigned shift = 0; ; shift += 7) {
+        if (p == end || shift > 63) {
+          throw std::runtime_error("sequence I/O: malformed varint payload");
+        }
+        const unsigned char byte = *p++;
+        zigzag |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+          break;
+        }
+      }
+      // check the delta before adding it, since a crafted varint may be
+      // near +-2^63 and the sum would overflow
+      const int64_t delta = static_cast<int64_t>((zigzag >> 1) ^ (0 - (zigzag & 1)));
+      if (delta < INT_MIN - previous || delta > INT_MAX - previous) {
+        throw std::runtime_error("sequence I/O: value out of range");
+      }
+      previous += delta;
+      x = static_cast<int>(previous);
+    }
+  } else {
+    throw std::runtime_error("sequence I/O: unknown encoding");
+  }
+  return seq;
+}
+
+// Parse decimal integers separated by whitespace, commas and brackets. Two
+// integers with no separator between them, as in "1-2", are rejected.
+sequence parse_sequence(const char* p, const char* end) {
+  using sequence_io_detail::is_separator;
+
+  sequence seq;
+  while (p != end) {
+    const char c = *p;
+    if (is_separator(c)) {
+      ++p;
+      continue;
+    }
+
+    const bool negative = c == '-';
+    if (negative) {
+      ++p;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+      throw std::runtime_error("sequence I/O: expected an integer");
+    }
+    int64_t magnitude = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+      magnitude = magnitude * 10 + (*p - '0');
+      if (magnitude > int64_t(INT_MAX) + 1) {
+        throw std::runtime_error("sequence I/O: integer out of range");
+      }
+    }
+    const int64_t value = negative ? -magnitude : magnitude;
+    if (value > INT_MAX) {
+      throw std::runtime_error("sequence I/O: integer out of range");
+    }
+    if (p != end && !is_separator(*p)) {
+      throw std::runtime_error("sequence I/O: expected a separator");
+    }
+    seq.push_back(static_cast<int>(value));
+  }
+  return seq;
+}
+
+sequence parse_sequence(const std::string& text) {
+  return parse_sequence(text.data(), text.data() + text.size());
+}
+
+// Write seq to path in the binary format.
+void write_sequence(const std::string& path, const sequence& seq,
+                    sequence_encoding encoding = SEQUENCE_RAW) {
+  auto bytes = encode_sequence(seq, encoding);
+  sequence_io_detail::write_file(path, bytes.data(), bytes.size());
+}
+
+// Write seq to path as text, in the format of sequence_to_string.
+void write_sequence_text(const std::string& path, const sequence& seq) {
+  auto text = sequence_to_string(seq);
+  text.push_back('\n');
+  sequence_io_detail::write_file(path, text.data(), text.size());
+}
+
+// Read a sequence from path, which may be in the binary format or text.
+sequence read_sequence(const std::string& path) {
+  auto bytes = sequence_io_detail::read_file(path);
+  if (is_binary_sequence(bytes.data(), bytes.size())) {
+    return decode_sequence(bytes.data(), bytes.size());
+  }
+  const char* text = reinterpret_cast<const char*>(bytes.data());
+  return parse_sequence(text, text + bytes.size());
+}
@@ -10,28 +10,70 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
 #include <random>
 #include <string>
-#include <sstream>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 using sequence = std::vector<int>;
 
+// Append the decimal representation of the integer x to out. This is the
+// formatting used by sequence_to_string; it writes two digits per step from
+// a lookup table and avoids the locale and stream machinery of operator<<.
+template <typename Integer>
+void append_decimal(std::string& out, Integer x) {
+  static const char pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+  using unsigned_type = typename std::make_unsigned<Integer>::type;
+  unsigned_type u = static_cast<unsigned_type>(x);
+  if (x < 0) {
+    out.push_back('-');
+    u = unsigned_type(0) - u;
+  }
+
+  char buffer[24];
+  char* end = buffer + sizeof(buffer);
+  char* p = end;
+  while (u >= 100) {
+    const unsigned pair = unsigned(u % 100) * 2;
+    u /= 100;
+    *--p = pairs[pair + 1];
+    *--p = pairs[pair];
+  }
+  if (u >= 10) {
+    const unsigned pair = unsigned(u) * 2;
+    *--p = pairs[pair + 1];
+    *--p = pairs[pair];
+  } else {
+    *--p = char('0' + u);
+  }
+  out.append(p, end);
+}
+
 // Convert a sequence into a human-readable string useful for pretty-printing
 // or debugging.
 std::string sequence_to_string(const sequence& seq) {
-  std::stringstream ss;
-  ss << "[";
+  std::string s;
+  // at most 11 characters per int plus the separator
+  s.reserve(2 + seq.size() * 13);
+  s.push_back('[');
   bool first = true;
   for (auto& x : seq) {
     if (!first) {
-      ss << ", ";
+      s.append(", ");
     }
-    ss << x;
+    append_decimal(s, x);
     first = false;
   }
-  ss << "]";
-  return ss.str();
+  s.push_back(']');
+  return s;
 }
 
 // Generate a pseudorandom sequence of the given size, using the given
@@ -53,28 +95,109 @@ sequence random_sequence(size_t size, unsigned seed, int max_element) {
     return result;
 }
 
-bool is_increasing(const sequence& A) {
-  for (size_t i = 1; i < A.size(); ++i) {
-      if (A[i-1] >= A[i]) {
+// Default projection for the templates below: yields each element unchanged.
+struct identity_projection {
+  template <typename T>
+  constexpr T&& operator()(T&& x) const noexcept {
+    return std::forward<T>(x);
+  }
+};
+
+// Adapts a strict weak ordering comp into the non-strict relation
+// "a is not greater than b", so that an engine instantiated with
+// non_decreasing<Compare> finds the longest non-decreasing subsequence
+// instead of the longest strictly increasing one.
+template <typename Compare = std::less<>>
+struct non_decreasing {
+  Compare comp;
+
+  template <typename T, typename U>
+  constexpr bool operator()(const T& a, const U& b) const {
+    return !comp(b, a);
+  }
+};
+
+// Engines that sort or binary-search need the ordering behind a "may follow"
+// relation rather than the relation itself. relation_order<Relation> gives
+// that ordering and whether equal elements may follow each other; it is
+// specialized for non_decreasing, and every other relation is taken to be a
+// strict ordering.
+template <typename Relation>
+struct relation_order {
+  using ordering = Relation;
+  static const bool strict = true;
+  static const ordering& of(const Relation& r) { return r; }
+};
+
+template <typename Compare>
+struct relation_order<non_decreasing<Compare>> {
+  using ordering = Compare;
+  static const bool strict = false;
+  static const ordering& of(const non_decreasing<Compare>& r) { return r.comp; }
+};
+
+// Return true when every element of [first, last) may follow its predecessor,
+// i.e. comp(proj(previous), proj(current)) holds for each adjacent pair. With
+// the default arguments that means strictly increasing under operator<.
+template <typename ForwardIt,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+bool is_increasing(ForwardIt first, ForwardIt last,
+                   Compare comp = Compare(), Projection proj = Projection()) {
+  if (first == last) {
+    return true;
+  }
+  for (ForwardIt prev = first++; first != last; prev = first++) {
+      if (!comp(proj(*prev), proj(*first))) {
         return false;
       }
   }
   return true;
 }
 
-sequence longest_increasing_end_to_beginning(const sequence& A) {
+template <typename Range,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+bool is_increasing(const Range& A,
+                   Compare comp = Compare(), Projection proj = Projection()) {
+  using std::begin;
+  using std::end;
+  return is_increasing(begin(A), end(A), comp, proj);
+}
 
-  const size_t n = A.size();
+// Return true when sub can be obtained from A by deleting elements.
+template <typename T>
+bool is_subsequence(const std::vector<T>& sub, const std::vector<T>& A) {
+  size_t k = 0;
+  for (size_t i = 0; i < A.size() && k < sub.size(); ++i) {
+    if (A[i] == sub[k]) {
+      ++k;
+    }
+  }
+  return k == sub.size();
+}
+
+// First phase of longest_increasing_end_to_beginning: fill H so that H[i] + 1
+// is the length of the longest increasing subsequence starting at A[i], and
+// return the overall length. H is reused as scratch space; it is resized to
+// n but only reallocates when its capacity is too small.
+template <typename RandomIt, typename Compare, typename Projection>
+size_t end_to_beginning_heights(RandomIt A, size_t n, std::vector<size_t>& H,
+                                Compare comp, Projection proj) {
+
+  if (n == 0) {
+    return 0;
+  }
 
   // populate the array H with 0 values
-  std::vector<size_t> H(n, 0);
+  H.assign(n, 0);
 
   // calculate the values of array H
   // note that i has to be declared signed, to avoid an infinite loop, since
   // the loop condition is i >= 0
-  for (signed int i = n-2;  i>= 0; i--) {
+  for (ptrdiff_t i = n-2;  i>= 0; i--) {
     for (size_t j = i+1; j < n ; j++) {
-        if (A[j] > A[i] && H[j] >= H[i]) {
+        if (H[j] >= H[i] && comp(proj(A[i]), proj(A[j]))) {
           H[i] = H[j] + 1;
         }
     }
@@ -82,23 +205,65 @@ sequence longest_increasing_end_to_beginning(const sequence& A) {
 
   // calculate in max the length of the longest subsequence
     // by adding 1 to the maximum value in H
-  auto max = *std::max_element(H.begin(), H.end()) + 1;
+  return *std::max_element(H.begin(), H.begin() + n) + 1;
+}
 
-  // allocate space for the subsequence R
-  std::vector<int> R(max);
+// Second phase: write the max elements of the subsequence to out, given the
+// H values computed by end_to_beginning_heights (or any other source of the
+// same heights).
+template <typename RandomIt, typename HeightIt, typename OutputIt>
+OutputIt end_to_beginning_trace(RandomIt A, size_t n,
+                                HeightIt H, size_t max,
+                                OutputIt out) {
 
   // add elements to R by whose H's values are in decreasing order,
     // starting with max-1
   // store in index the H values sought
 
-    size_t index = max-1, j = 0;
-    for (size_t i = 0; i < n; ++i) {
+    size_t index = max-1;
+    for (size_t i = 0, j = 0; i < n && j < max; ++i) {
       if (H[i] == index) {
-          R[j] = A[i];
+          *out++ = A[i];
           index--;
           j++;
       }
     }
 
-  return sequence(R.begin(), R.begin() + max);
+  return out;
+}
+
+// Longest increasing subsequence of [first, last), where element y may follow
+// element x when comp(proj(x), proj(y)) holds. The elements themselves (not
+// their projections) are returned, in their original order. The input is
+// read in place through the iterators, so no copy into a sequence is needed.
+template <typename RandomIt,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+std::vector<typename std::iterator_traits<RandomIt>::value_type>
+longest_increasing_end_to_beginning(RandomIt A, RandomIt last,
+                                    Compare comp = Compare(),
+                                    Projection proj = Projection()) {
+
+  const size_t n = last - A;
+
+  std::vector<size_t> H;
+  auto max = end_to_beginning_heights(A, n, H, comp, proj);
+
+  // allocate space for the subsequence R
+  std::vector<typename std::iterator_traits<RandomIt>::value_type> R;
+  R.reserve(max);
+  end_to_beginning_trace(A, n, H.begin(), max, std::back_inserter(R));
+
+  return R;
+}
+
+template <typename Range,
+          typename Compare = std::less<>,
+          typename Projection = identity_projection>
+auto longest_increasing_end_to_beginning(const Range& A,
+                                         Compare comp = Compare(),
+                                         Projection proj = Projection()) {
+  using std::begin;
+  using std::end;
+  return longest_increasing_end_to_beginning(begin(A), end(A), comp, proj);
 }
@@ -6,10 +6,29 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <cassert>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <set>
+#include <utility>
+#include <stdexcept>
 
 #include "rubrictest.hpp"
 
 #include "subsequence.hpp"
+#include "lis_batch.hpp"
+#include "lis_chain.hpp"
+#include "lis_differential.hpp"
+#include "lis_dynamic.hpp"
+#include "lis_external.hpp"
+#include "lis_fenwick.hpp"
+#include "lis_patience.hpp"
+#include "lis_universe.hpp"
+#include "tails_search.hpp"
+#include "lis_window.hpp"
+#include "sequence_generators.hpp"
+#include "sequence_io.hpp"
 
 int main() {
 
@@ -72,6 +91,492 @@ int main() {
                      [&]() {
 		       TEST_EQUAL("input8", solution8, longest_increasing_end_to_beginning(input8));
                      });
+    rubric.criterion("generic element types", 1,
+                     [&]() {
+		       const std::vector<int64_t> stamps{1700000000123, 1600000000000, 1700000000124, 1700000000125};
+		       TEST_EQUAL("int64 timestamps",
+				  (std::vector<int64_t>{1700000000123, 1700000000124, 1700000000125}),
+				  longest_increasing_end_to_beginning(stamps));
+		       const std::vector<double> reals{0.5, -1.25, 0.75, 0.625, 2.0};
+		       TEST_EQUAL("doubles", (std::vector<double>{0.5, 0.75, 2.0}),
+				  longest_increasing_end_to_beginning(reals));
+		       TEST_EQUAL("iterator range", (sequence{0, 8, 12}),
+				  longest_increasing_end_to_beginning(input2.begin(), input2.begin() + 5));
+		       TEST_TRUE("is_increasing int64", is_increasing(std::vector<int64_t>{-5, 0, 1LL << 40}));
+		       TEST_FALSE("is_increasing doubles", is_increasing(std::vector<double>{0.5, 0.5}));
+		     });
+
+    rubric.criterion("comparator and projection", 1,
+                     [&]() {
+		       struct reading { int sensor; double value; };
+		       const std::vector<reading> readings{{7, 3.0}, {1, 1.0}, {5, 2.0}, {2, 4.0}, {9, 5.0}};
+		       auto by_value = [](const reading& r) { return r.value; };
+		       auto chain = longest_increasing_end_to_beginning(readings, std::less<>(), by_value);
+		       TEST_EQUAL("projected length", 4, chain.size());
+		       TEST_EQUAL("projected first sensor", 1, chain[0].sensor);
+		       TEST_TRUE("projected chain increasing", is_increasing(chain, std::less<>(), by_value));
+		       auto decreasing = longest_increasing_end_to_beginning(input2, std::greater<>());
+		       TEST_EQUAL("decreasing via greater", (sequence{12, 10, 6, 5, 3}), decreasing);
+		       TEST_TRUE("decreasing chain", is_increasing(decreasing, std::greater<>()));
+		     });
+
+    rubric.criterion("non-decreasing variant", 1,
+                     [&]() {
+		       TEST_EQUAL("input8 non-decreasing", input8,
+				  longest_increasing_end_to_beginning(input8, non_decreasing<>()));
+		       TEST_EQUAL("plateau", (sequence{1, 3, 3, 3, 4}),
+				  longest_increasing_end_to_beginning(sequence{1, 3, 3, 2, 3, 4}, non_decreasing<>()));
+		       TEST_TRUE("is_increasing non-decreasing", is_increasing(input8, non_decreasing<>()));
+		       TEST_FALSE("is_increasing strict", is_increasing(input8));
+		       TEST_TRUE("empty input", longest_increasing_end_to_beginning(sequence{}).empty());
+		     });
+    rubric.criterion("batch", 1,
+                     [&]() {
+		       std::vector<sequence> inputs{input1, input2, input3, input4, input5, input6, input7, input8, sequence{}};
+		       for (unsigned seed = 0; seed < 500; ++seed) {
+			 inputs.push_back(random_sequence(10 + seed % 90, seed, 1000));
+		       }
+		       sequence values;
+		       std::vector<size_t> offsets{0};
+		       for (auto& input : inputs) {
+			 values.insert(values.end(), input.begin(), input.end());
+			 offsets.push_back(values.size());
+		       }
+		       work_stealing_pool pool(4);
+		       for (int round = 0; round < 2; ++round) {
+			 auto result = longest_increasing_batch(pool, values, offsets);
+			 TEST_EQUAL("batch size", inputs.size(), result.size());
+			 for (size_t s = 0; s < inputs.size(); ++s) {
+			   TEST_EQUAL("batch matches single", longest_increasing_end_to_beginning(inputs[s]), result.subsequence(s));
+			 }
+		       }
+		     });
+    rubric.criterion("sliding window", 1,
+                     [&]() {
+		       for (size_t k : {1, 2, 5, 17, 64}) {
+			 for (unsigned seed = 0; seed < 4; ++seed) {
+			   auto input = random_sequence(300, seed, seed % 2 ? 20 : 1000);
+			   std::vector<size_t> selected{0, 3, 100, 200};
+			   std::vector<sequence> witnesses;
+			   auto lengths = longest_increasing_windows(input, k, selected, witnesses);
+			   TEST_EQUAL("window count", input.size() - k + 1, lengths.size());
+			   for (size_t t = 0; t < lengths.size(); ++t) {
+			     auto expected = longest_increasing_end_to_beginning(input.begin() + t, input.begin() + t + k);
+			     TEST_EQUAL("window length", expected.size(), lengths[t]);
+			   }
+			   TEST_EQUAL("witness count", selected.size(), witnesses.size());
+			   for (size_t w = 0; w < selected.size(); ++w) {
+			     auto t = selected[w];
+			     TEST_EQUAL("witness", longest_increasing_end_to_beginning(input.begin() + t, input.begin() + t + k), witnesses[w]);
+			   }
+			 }
+		       }
+		       TEST_EQUAL("non-decreasing windows", (std::vector<size_t>{3, 2, 2}),
+				  longest_increasing_windows(sequence{1, 1, 2, 0, 2}, 3, non_decreasing<>()));
+		       TEST_TRUE("too few elements", longest_increasing_windows(input1, 6).empty());
+		     });
+    rubric.criterion("external memory", 1,
+                     [&]() {
+		       const std::string path = "external_lis_test.bin";
+		       for (unsigned seed = 0; seed < 3; ++seed) {
+			 auto input = random_sequence(2000, seed, 1000);
+			 for (auto& x : input) {
+			   x -= 500;
+			 }
+			 auto expected = longest_increasing_end_to_beginning(input);
+
+			 write_raw_sequence<int32_t>(path, input);
+			 auto r32 = longest_increasing_external<int32_t>(path, 64);
+			 TEST_EQUAL("int32 length", expected.size(), r32.length());
+			 TEST_TRUE("int32 increasing", is_increasing(r32.values));
+			 TEST_TRUE("int32 indices increasing", is_increasing(r32.indices));
+			 for (size_t k = 0; k < r32.length(); ++k) {
+			   TEST_EQUAL("int32 value at index", input[r32.indices[k]], r32.values[k]);
+			 }
+
+			 std::vector<int64_t> wide(input.begin(), input.end());
+			 for (auto& x : wide) {
+			   x *= int64_t(1) << 33;
+			 }
+			 write_raw_sequence<int64_t>(path, wide);
+			 auto r64 = longest_increasing_external<int64_t>(path, 100);
+			 TEST_EQUAL("int64 length", expected.size(), r64.length());
+			 TEST_TRUE("int64 increasing", is_increasing(r64.values));
+			 for (size_t k = 0; k < r64.length(); ++k) {
+			   TEST_EQUAL("int64 value at index", wide[r64.indices[k]], r64.values[k]);
+			 }
+		       }
+		       write_raw_sequence<int32_t>(path, sequence{});
+		       TEST_EQUAL("empty file", 0, longest_increasing_external<int32_t>(path).length());
+		       std::remove(path.c_str());
+		     });
+    rubric.criterion("weighted and counting", 1,
+                     [&]() {
+		       // exhaustive reference: heaviest weight and number of longest
+		       // increasing index subsets, each checked with is_increasing
+		       auto reference = [](const sequence& A, const std::vector<int64_t>& w,
+					   int64_t& heaviest, size_t& longest, uint64_t& count) {
+			 heaviest = 0;
+			 longest = 0;
+			 count = 0;
+			 for (uint32_t mask = 0; mask < (1u << A.size()); ++mask) {
+			   sequence candidate;
+			   int64_t weight = 0;
+			   for (size_t i = 0; i < A.size(); ++i) {
+			     if (mask & (1u << i)) {
+			       candidate.push_back(A[i]);
+			       weight += w[i];
+			     }
+			   }
+			   if (!is_increasing(candidate)) {
+			     continue;
+			   }
+			   heaviest = std::max(heaviest, weight);
+			   if (candidate.size() > longest) {
+			     longest = candidate.size();
+			     count = 0;
+			   }
+			   if (candidate.size() == longest) {
+			     ++count;
+			   }
+			 }
+		       };
+
+		       for (unsigned seed = 0; seed < 60; ++seed) {
+			 auto A = random_sequence(1 + seed % 14, seed, seed % 3 ? 10 : 100);
+			 auto raw = random_sequence(A.size(), seed + 1000, 40);
+			 std::vector<int64_t> w(raw.begin(), raw.end());
+			 for (auto& x : w) {
+			   x -= 10;
+			 }
+			 int64_t heaviest;
+			 size_t longest;
+			 uint64_t count;
+			 reference(A, w, heaviest, longest, count);
+
+			 auto weighted = heaviest_increasing_subsequence(A, w);
+			 TEST_EQUAL("heaviest weight", heaviest, weighted.weight);
+			 TEST_TRUE("heaviest increasing", is_increasing(weighted.values));
+			 TEST_TRUE("heaviest indices", is_increasing(weighted.indices));
+			 int64_t sum = 0;
+			 for (size_t k = 0; k < weighted.indices.size(); ++k) {
+			   TEST_EQUAL("heaviest value", A[weighted.indices[k]], weighted.values[k]);
+			   sum += w[weighted.indices[k]];
+			 }
+			 TEST_EQUAL("heaviest sum", heaviest, sum);
+
+			 auto counted = count_longest_increasing(A);
+			 TEST_EQUAL("count length", longest, counted.length);
+			 TEST_EQUAL("count", count, counted.count);
+			 TEST_EQUAL("count modulo 7", count % 7, count_longest_increasing(A, 7).count);
+		       }
+
+		       auto big = random_sequence(5000, 1, 1000);
+		       std::vector<int> unit(big.size(), 1);
+		       TEST_EQUAL("unit weights give the LIS length",
+				  int(longest_increasing_end_to_beginning(big).size()),
+				  heaviest_increasing_subsequence(big, unit).weight);
+		       TEST_EQUAL("count length matches DP",
+				  longest_increasing_end_to_beginning(big).size(),
+				  count_longest_increasing(big, 1000000007).length);
+		       TEST_EQUAL("all equal, non-decreasing", 1,
+				  count_longest_increasing(sequence{2, 2, 2}, 0, non_decreasing<>()).count);
+		       TEST_EQUAL("all equal, strict", 3, count_longest_increasing(sequence{2, 2, 2}).count);
+		       TEST_EQUAL("doubling count", uint64_t(1) << 40,
+				  count_longest_increasing(std::vector<int>{
+				      1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 17, 16, 19, 18,
+				      21, 20, 23, 22, 25, 24, 27, 26, 29, 28, 31, 30, 33, 32, 35, 34, 37, 36, 39, 38,
+				      41, 40, 43, 42, 45, 44, 47, 46, 49, 48, 51, 50, 53, 52, 55, 54, 57, 56, 59, 58,
+				      61, 60, 63, 62, 65, 64, 67, 66, 69, 68, 71, 70, 73, 72, 75, 74, 77, 76, 79, 78}).count);
+		     });
+    rubric.criterion("fast engines", 1,
+                     [&]() {
+		       const std::vector<sequence> inputs{input1, input2, input3, input4, input5, input6, input7, input8};
+		       for (size_t t = 0; t < inputs.size(); ++t) {
+			 auto expected = longest_increasing_end_to_beginning(inputs[t]).size();
+			 TEST_EQUAL("patience length", expected, longest_increasing_patience(inputs[t]).size());
+			 TEST_EQUAL("fast length", expected, longest_increasing_fast(inputs[t]).size());
+		       }
+		       for (unsigned seed = 0; seed < 40; ++seed) {
+			 auto input = random_sequence(50 + 40 * seed, seed, seed % 4 ? 1000 : 5);
+			 for (auto& x : input) {
+			   x -= 300;
+			 }
+			 auto expected = longest_increasing_end_to_beginning(input).size();
+			 auto patience = longest_increasing_patience(input);
+			 auto universe = longest_increasing_small_universe(input.begin(), input.end(), -300, 700);
+			 auto fast = longest_increasing_fast(input);
+			 for (auto* R : {&patience, &universe, &fast}) {
+			   TEST_EQUAL("engine length", expected, R->size());
+			   TEST_TRUE("engine increasing", is_increasing(*R));
+			   TEST_TRUE("engine subsequence", is_subsequence(*R, input));
+			 }
+			 auto non_strict = longest_increasing_patience(input, non_decreasing<>());
+			 TEST_EQUAL("patience non-decreasing",
+				    longest_increasing_end_to_beginning(input, non_decreasing<>()).size(), non_strict.size());
+			 TEST_TRUE("patience non-decreasing valid", is_increasing(non_strict, non_decreasing<>()));
+		       }
+		       const std::vector<int64_t> wide{-(int64_t(1) << 62), 5, int64_t(1) << 62, 6, 7};
+		       TEST_EQUAL("wide range falls back", 4, longest_increasing_fast(wide).size());
+		       TEST_TRUE("fast on empty", longest_increasing_fast(sequence{}).empty());
+
+		       successor_bitset bits(100000);
+		       std::set<size_t> reference;
+		       auto ops = random_sequence(20000, 7, 99999);
+		       for (size_t k = 0; k < ops.size(); ++k) {
+			 size_t x = ops[k];
+			 if (k % 3 == 2) {
+			   bits.erase(x);
+			   reference.erase(x);
+			 } else {
+			   bits.insert(x);
+			   reference.insert(x);
+			 }
+			 size_t probe = ops[(k * 7919) % ops.size()];
+			 auto up = reference.lower_bound(probe);
+			 TEST_EQUAL("successor", up == reference.end() ? size_t(successor_bitset::NONE) : *up, bits.successor(probe));
+			 TEST_EQUAL("predecessor", up == reference.begin() ? size_t(successor_bitset::NONE) : *std::prev(up), bits.predecessor(probe));
+		       }
+		     });
+    rubric.criterion("tails search kernels", 1,
+                     [&]() {
+		       const std::less<> less;
+		       for (size_t n : {0, 1, 3, 4, 5, 16, 17, 33, 100}) {
+			 auto tails = random_sequence(n, unsigned(n), 50);
+			 std::sort(tails.begin(), tails.end());
+			 std::vector<double> real_tails(tails.begin(), tails.end());
+			 const int* t = tails.data();
+			 for (int key = -1; key <= 51; ++key) {
+			   const size_t lower = std::lower_bound(tails.begin(), tails.end(), key) - tails.begin();
+			   const size_t upper = std::upper_bound(tails.begin(), tails.end(), key) - tails.begin();
+			   TEST_EQUAL("binary strict", lower, tails_binary_search<true>(t, n, key, less));
+			   TEST_EQUAL("binary non-strict", upper, tails_binary_search<false>(t, n, key, less));
+			   TEST_EQUAL("linear strict", lower, tails_linear_search<true>(t, n, key, less));
+			   TEST_EQUAL("linear non-strict", upper, tails_linear_search<false>(t, n, key, less));
+			   TEST_EQUAL("dispatch strict", lower, tails_search<true>(t, n, key, less));
+			   const double real_key = key;
+			   TEST_EQUAL("generic linear", upper, tails_linear_search<false>(real_tails.data(), n, real_key, less));
+			   TEST_EQUAL("generic binary", lower, tails_binary_search<true>(real_tails.data(), n, real_key, less));
+			 }
+		       }
+		     });
+    rubric.criterion("counter-based generators", 1,
+                     [&]() {
+		       work_stealing_pool serial(1), parallel(3);
+		       const size_t n = 200000;
+		       auto one = counter_random_sequence(n, 42, 1000, serial);
+		       TEST_EQUAL("thread count independent", one, counter_random_sequence(n, 42, 1000, parallel));
+		       TEST_NOT_EQUAL("seed matters", one, counter_random_sequence(n, 43, 1000, serial));
+		       TEST_TRUE("in range", *std::min_element(one.begin(), one.end()) == 0 &&
+					      *std::max_element(one.begin(), one.end()) == 1000);
+		       sequence slice(500);
+		       fill_sequence(slice.data(), 123456, 123456 + slice.size(), uniform_generator{42, 1000});
+		       TEST_TRUE("any index range", std::equal(slice.begin(), slice.end(), one.begin() + 123456));
+
+		       auto sorted = sorted_sequence(n, 1000, parallel);
+		       TEST_TRUE("sorted", is_increasing(sorted, non_decreasing<>()));
+		       TEST_TRUE("sorted ends", sorted.front() == 0 && sorted.back() == 1000);
+		       auto reversed = reverse_sorted_sequence(n, 1000, parallel);
+		       TEST_TRUE("reverse sorted", is_increasing(reversed, non_decreasing<std::greater<>>()));
+
+		       auto nearly = nearly_sorted_sequence(n, 5, 1000000, 0.01, parallel);
+		       TEST_EQUAL("nearly sorted thread independent", nearly,
+				  nearly_sorted_sequence(n, 5, 1000000, 0.01, serial));
+		       size_t descents = 0;
+		       for (size_t i = 1; i < n; ++i) {
+			 descents += nearly[i] < nearly[i-1];
+		       }
+		       TEST_TRUE("nearly sorted", descents > 0 && descents < n / 50);
+
+		       auto plateaus = plateau_sequence(n, 9, 1000, 100, parallel);
+		       for (size_t i = 0; i < n; ++i) {
+			 TEST_EQUAL("plateau", plateaus[i - i % 100], plateaus[i]);
+		       }
+		     });
+    rubric.criterion("sequence I/O", 1,
+                     [&]() {
+		       TEST_EQUAL("to_string", "[0, 8, 4, 12, 2]", sequence_to_string(input1));
+		       TEST_EQUAL("to_string extremes", "[-2147483648, 2147483647, -7, 0, 100]",
+				  sequence_to_string(sequence{INT_MIN, INT_MAX, -7, 0, 100}));
+		       TEST_EQUAL("to_string empty", "[]", sequence_to_string(sequence{}));
+
+		       auto input = random_sequence(10000, 3, 1000);
+		       input.push_back(INT_MIN);
+		       input.push_back(INT_MAX);
+		       input.push_back(-1);
+		       TEST_EQUAL("parse round trip", input, parse_sequence(sequence_to_string(input)));
+		       TEST_EQUAL("parse whitespace", (sequence{1, -2, 3}), parse_sequence(" 1\n-2,\t3 "));
+		       for (auto encoding : {SEQUENCE_RAW, SEQUENCE_DELTA_VARINT}) {
+			 auto bytes = encode_sequence(input, encoding);
+			 TEST_EQUAL("binary round trip", input, decode_sequence(bytes.data(), bytes.size()));
+		       }
+		       work_stealing_pool pool(1);
+		       auto sorted = sorted_sequence(100000, 1000000, pool);
+		       TEST_LT("delta varint is compact", encode_sequence(sorted, SEQUENCE_DELTA_VARINT).size(),
+			       SEQUENCE_HEADER_SIZE + 2 * sorted.size());
+
+		       const std::string path = "sequence_io_test.bin";
+		       write_sequence(path, input, SEQUENCE_DELTA_VARINT);
+		       TEST_EQUAL("binary file", input, read_sequence(path));
+		       write_sequence_text(path, input);
+		       TEST_EQUAL("text file", input, read_sequence(path));
+		       std::remove(path.c_str());
+
+		       auto raw = encode_sequence(input);
+		       bool threw = false;
+		       try {
+			 decode_sequence(raw.data(), raw.size() - 1);
+		       } catch (const std::runtime_error&) {
+			 threw = true;
+		       }
+		       TEST_TRUE("truncated input rejected", threw);
+		       // -5 then a ten-byte varint decoding to a delta of -2^63 must not overflow
+		       auto huge = encode_sequence(sequence{-5, 0}, SEQUENCE_DELTA_VARINT);
+		       huge.pop_back();
+		       huge.insert(huge.end(), 9, 0xff);
+		       huge.push_back(0x01);
+		       threw = false;
+		       try {
+			 decode_sequence(huge.data(), huge.size());
+		       } catch (const std::runtime_error&) {
+			 threw = true;
+		       }
+		       TEST_TRUE("overflowing delta rejected", threw);
+		       threw = false;
+		       try {
+			 parse_sequence("1, 2, 3000000000");
+		       } catch (const std::runtime_error&) {
+			 threw = true;
+		       }
+		       TEST_TRUE("out of range rejected", threw);
+		       for (auto text : {"1-2", "1 2x", "[1,2-3]"}) {
+			 threw = false;
+			 try {
+			   parse_sequence(text);
+			 } catch (const std::runtime_error&) {
+			   threw = true;
+			 }
+			 TEST_TRUE(std::string("missing separator rejected: ") + text, threw);
+		       }
+		     });
+    rubric.criterion("dominance chains", 1,
+                     [&]() {
+		       using point = std::pair<int, int>;
+		       const std::vector<point> envelopes{{5, 4}, {6, 4}, {6, 7}, {2, 3}};
+		       TEST_EQUAL("envelopes", (std::vector<point>{{2, 3}, {5, 4}, {6, 7}}),
+				  longest_dominance_chain(envelopes));
+		       TEST_TRUE("equal first keys", longest_dominance_chain(std::vector<point>{{1, 1}, {1, 2}, {1, 3}}).size() == 1);
+
+		       for (unsigned seed = 0; seed < 40; ++seed) {
+			 const size_t n = 1 + seed % 12;
+			 auto a = random_sequence(n, seed, 6), b = random_sequence(n, seed + 100, 6);
+			 std::vector<point> points;
+			 for (size_t i = 0; i < n; ++i) {
+			   points.emplace_back(a[i], b[i]);
+			 }
+
+			 // brute force over every subset, validated with is_dominance_chain
+			 size_t best = 0;
+			 for (uint32_t mask = 0; mask < (1u << n); ++mask) {
+			   std::vector<point> subset;
+			   for (size_t i = 0; i < n; ++i) {
+			     if (mask & (1u << i)) {
+			       subset.push_back(points[i]);
+			     }
+			   }
+			   std::sort(subset.begin(), subset.end());
+			   if (is_dominance_chain(subset)) {
+			     best = std::max(best, subset.size());
+			   }
+			 }
+
+			 auto chain = longest_dominance_chain(points);
+			 TEST_EQUAL("chain length", best, chain.size());
+			 TEST_TRUE("chain valid", is_dominance_chain(chain));
+			 auto remaining = std::multiset<point>(points.begin(), points.end());
+			 for (auto& p : chain) {
+			   TEST_TRUE("chain uses input points", remaining.count(p) > 0);
+			   remaining.erase(remaining.find(p));
+			 }
+
+			 auto sorted = points;
+			 std::sort(sorted.begin(), sorted.end());
+			 TEST_EQUAL("chain length matches DP", longest_increasing_end_to_beginning(sorted, dominates<>()).size(), chain.size());
+		       }
+		     });
+    rubric.criterion("dynamic updates", 1,
+                     [&]() {
+		       for (size_t block : {1, 7, 64}) {
+			 auto values = random_sequence(1000, unsigned(block), 300);
+			 dynamic_lis<int> strict(values, std::less<>(), block);
+			 dynamic_lis<int, non_decreasing<>> loose(values, non_decreasing<>(), block);
+			 auto positions = random_sequence(600, 1, 999), updates = random_sequence(600, 2, 300);
+			 for (size_t k = 0; k < positions.size(); ++k) {
+			   values[positions[k]] = updates[k];
+			   strict.update(positions[k], updates[k]);
+			   loose.update(positions[k], updates[k]);
+			   if (k % 3 == 0) {
+			     TEST_EQUAL("dynamic strict", longest_increasing_patience(values).size(), strict.lis_length());
+			     TEST_EQUAL("dynamic non-decreasing",
+					longest_increasing_patience(values, non_decreasing<>()).size(), loose.lis_length());
+			   }
+			 }
+			 auto witness = strict.witness();
+			 TEST_EQUAL("dynamic witness length", strict.lis_length(), witness.size());
+			 TEST_TRUE("dynamic witness", is_increasing(witness) && is_subsequence(witness, values));
+		       }
+		       // long tails grow the blocks instead of the checkpoint memory
+		       sequence sorted(20000);
+		       std::iota(sorted.begin(), sorted.end(), 0);
+		       dynamic_lis<int> ramp(sorted, std::less<>(), 16);
+		       TEST_TRUE("dynamic checkpoints bounded",
+				 ramp.checkpoint_elements() <= DYNAMIC_LIS_CHECKPOINT_FACTOR * sorted.size());
+		       TEST_TRUE("dynamic block grew", ramp.block_size() > 16);
+		       sorted[10] = -1;
+		       ramp.update(10, -1);
+		       TEST_EQUAL("dynamic sorted update", longest_increasing_patience(sorted).size(), ramp.lis_length());
+		       sorted[19999] = 5;
+		       ramp.update(19999, 5);
+		       TEST_EQUAL("dynamic sorted tail update", longest_increasing_patience(sorted).size(), ramp.lis_length());
+		       // and so do edits that lengthen the tails
+		       sequence falling(2000);
+		       std::iota(falling.rbegin(), falling.rend(), 0);
+		       dynamic_lis<int> rising(falling, std::less<>(), 4);
+		       for (size_t i = 0; i < falling.size(); ++i) {
+			 falling[i] = int(i);
+			 rising.update(i, int(i));
+			 if (i % 100 == 99) {
+			   TEST_EQUAL("dynamic rising", longest_increasing_patience(falling).size(), rising.lis_length());
+			 }
+		       }
+		       TEST_TRUE("dynamic rising bounded",
+				 rising.checkpoint_elements() <= DYNAMIC_LIS_CHECKPOINT_FACTOR * falling.size());
+		       dynamic_lis<int> empty(sequence{});
+		       TEST_EQUAL("dynamic empty", 0, empty.lis_length());
+		     });
+
+    rubric.criterion("differential validation", 1,
+                     [&]() {
+		       work_stealing_pool pool(4);
+		       auto engines = lis_engines();
+		       auto report = run_differential(pool, engines, 5000, 12, 1);
+		       TEST_EQUAL("cases", size_t(5000), report.cases);
+		       TEST_TRUE("engines agree", report.failures.empty());
+
+		       // an engine that drops the last element of long outputs
+		       engines.push_back({"broken", [](const sequence& A) {
+			 auto R = longest_increasing_patience(A);
+			 if (R.size() >= 3) {
+			   R.pop_back();
+			 }
+			 return R;
+		       }, SIZE_MAX});
+		       auto broken = run_differential(pool, engines, 20000, 12, 1, 3);
+		       TEST_EQUAL("failures", size_t(3), broken.failures.size());
+		       for (auto& failure : broken.failures) {
+			 TEST_EQUAL("minimized", (sequence{0, 1, 2}), failure.minimized);
+		       }
+		     });
   
     return rubric.run();
 }
@@ -17,19 +17,25 @@
 #include "timer.hpp"
 
 #include "subsequence.hpp"
+#include "lis_patience.hpp"
+#include "lis_universe.hpp"
+#include "sequence_io.hpp"
 
 void print_bar() {
   std::cout << std::string(79, '-') << std::endl;
 }
 
-int main() {
+// Usage: subsequence_timing [input-file]
+// The input file may be binary or text, as read by read_sequence.
+int main(int argc, char* argv[]) {
 
-  const size_t n = 15000;
+  // Use a hardcoded seed for reproducibility between runs, unless an input
+  // file is given.
+  auto input = argc > 1 ? read_sequence(argv[1]) : random_sequence(15000, 0, 1000);
 
-  assert(n > 0);
+  const size_t n = input.size();
 
-  // Use a hardcoded seed for reproducibility between runs.
-  auto input = random_sequence(n, 0, 1000);
+  assert(n > 0);
 
   Timer timer;
   double elapsed;
@@ -47,5 +53,21 @@ int main() {
             << "of length = " << etb_output.size() << std::endl;
   std::cout << "elapsed time=" << elapsed << " seconds" << std::endl;
 
+  print_bar();
+  std::cout << "patience sorting" << std::endl;
+  timer.reset();
+  auto patience_output = longest_increasing_patience(input);
+  elapsed = timer.elapsed();
+  std::cout << "of length = " << patience_output.size() << std::endl;
+  std::cout << "elapsed time=" << elapsed << " seconds" << std::endl;
+
+  print_bar();
+  std::cout << "small universe" << std::endl;
+  timer.reset();
+  auto universe_output = longest_increasing_fast(input);
+  elapsed = timer.elapsed();
+  std::cout << "of length = " << universe_output.size() << std::endl;
+  std::cout << "elapsed time=" << elapsed << " seconds" << std::endl;
+
   return 0;
 }
@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// tails_benchmark.cpp
+//
+// Micro-benchmark of the tails_search.hpp kernels against std::lower_bound,
+// first on isolated searches over sorted tails arrays of various lengths,
+// then inside complete patience sorting runs on random_sequence inputs of
+// the subsequence_timing.cpp size and larger.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "timer.hpp"
+
+#include "subsequence.hpp"
+#include "tails_search.hpp"
+
+void print_bar() {
+  std::cout << std::string(79, '-') << std::endl;
+}
+
+// Keeps the optimizer from discarding the searches.
+volatile size_t sink;
+
+// Time searches for every key in keys using search, in nanoseconds per
+// search.
+template <typename Search>
+double time_searches(const sequence& keys, Search search) {
+  Timer timer;
+  size_t total = 0;
+  for (auto key : keys) {
+    total += search(key);
+  }
+  double elapsed = timer.elapsed();
+  sink = total;
+  return elapsed * 1e9 / keys.size();
+}
+
+// Patience sorting length only, placing each element with search.
+template <typename Search>
+size_t patience_length(const sequence& A, Search search) {
+  sequence tails;
+  for (auto x : A) {
+    const size_t level = search(tails, x);
+    if (level == tails.size()) {
+      tails.push_back(x);
+    } else {
+      tails[level] = x;
+    }
+  }
+  return tails.size();
+}
+
+int main() {
+
+  const std::less<> less;
+  const auto keys = random_sequence(1000000, 1, 1000000);
+
+  print_bar();
+  std::cout << "ns per search of a random key" << std::endl
+            << "tails\tstd::lower_bound\tbranchless\tlinear\ttails_search" << std::endl;
+  for (size_t n : {4, 8, 16, 32, 64, 128, 256, 1024, 4096, 65536}) {
+    auto tails = random_sequence(n, 2, 1000000);
+    std::sort(tails.begin(), tails.end());
+    const int* t = tails.data();
+
+    double stl = time_searches(keys, [&](int key) {
+      return size_t(std::lower_bound(t, t + n, key) - t);
+    });
+    double branchless = time_searches(keys, [&](int key) {
+      return tails_binary_search<true>(t, n, key, less);
+    });
+    double linear = time_searches(keys, [&](int key) {
+      return tails_linear_search<true>(t, n, key, less);
+    });
+    double chosen = time_searches(keys, [&](int key) {
+      return tails_search<true>(t, n, key, less);
+    });
+    std::cout << n << "\t" << stl << "\t\t\t" << branchless << "\t\t"
+              << linear << "\t" << chosen << std::endl;
+  }
+
+  print_bar();
+  std::cout << "patience sorting, seconds" << std::endl
+            << "n\tmax\tstd::lower_bound\ttails_search" << std::endl;
+  for (size_t n : {15000, 1000000, 10000000}) {
+    for (int max_element : {1000, 1000000000}) {
+      auto input = random_sequence(n, 0, max_element);
+      Timer timer;
+      size_t stl_length = patience_length(input, [](const sequence& tails, int x) {
+        return size_t(std::lower_bound(tails.begin(), tails.end(), x) - tails.begin());
+      });
+      double stl = timer.elapsed();
+      timer.reset();
+      size_t kernel_length = patience_length(input, [&](const sequence& tails, int x) {
+        return tails_search<true>(tails.data(), tails.size(), x, less);
+      });
+      double kernel = timer.elapsed();
+      assert(stl_length == kernel_length);
+      std::cout << n << "\t" << max_element << "\t" << stl << "\t\t" << kernel << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// tails_search.hpp
+//
+// Search kernels for the tails array of patience sorting. Each returns the
+// number of leading tails that come before key, i.e. the level at which key
+// is placed: the tails < key for strict LIS, or <= key for non-strict LIS.
+//
+// On random input the outcome of each comparison in std::lower_bound is a
+// coin flip, so most of its time goes to branch mispredictions. The kernels
+// here avoid data-dependent branches:
+//
+//  - tails_binary_search halves the range with a conditional move instead of
+//    a branch, so every search of n tails runs the same ~log2(n) steps; and
+//  - tails_linear_search counts the tails before key over the whole array,
+//    comparing four int keys at a time with SSE2.
+//
+// tails_search picks between them by the current number of tails. The
+// limits below come from tails_benchmark: on an x86-64 test machine the
+// branchless search is 3-5x faster than std::lower_bound at every length,
+// the linear scan beats it only up to about 16 tails, and prefetching
+// both possible next midpoints pays off once the array no longer fits in
+// the L2 cache.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Tails arrays up to this length are searched linearly.
+const size_t TAILS_LINEAR_LIMIT = 16;
+
+// Binary searches over more tails than this prefetch ahead.
+const size_t TAILS_PREFETCH_LIMIT = size_t(1) << 18;
+
+// Whether tail t comes before key, i.e. t < key when Strict and t <= key
+// otherwise.
+template <bool Strict, typename K, typename Ordering>
+inline bool tail_before(const K& t, const K& key, const Ordering& ordering) {
+  return Strict ? ordering(t, key) : !ordering(key, t);
+}
+
+// Branchless binary search over the sorted tails[0 .. n).
+template <bool Strict, typename K, typename Ordering>
+inline size_t tails_binary_search(const K* tails, size_t n, const K& key,
+                                  const Ordering& ordering) {
+  if (n == 0) {
+    return 0;
+  }
+  const K* base = tails;
+#if defined(__GNUC__)
+  while (n > TAILS_PREFETCH_LIMIT) {
+    const size_t half = n / 2;
+    __builtin_prefetch(base + half / 2);
+    __builtin_prefetch(base + half + half / 2);
+    base = tail_before<Strict>(base[half], key, ordering) ? base + half : base;
+    n -= half;
+  }
+#endif
+  while (n > 1) {
+    const size_t half = n / 2;
+    base = tail_before<Strict>(base[half], key, ordering) ? base + half : base;
+    n -= half;
+  }
+  return (base - tails) + tail_before<Strict>(*base, key, ordering);
+}
+
+// Linear counting search over tails[0 .. n); the generic version relies on
+// the compiler to turn the sum into straight-line code.
+template <bool Strict, typename K, typename Ordering>
+struct tails_linear_kernel {
+  static size_t search(const K* tails, size_t n, const K& key,
+                       const Ordering& ordering) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+      count += tail_before<Strict>(tails[i], key, ordering);
+    }
+    return count;
+  }
+};
+
+#if defined(__SSE2__)
+// SSE2 version for int keys under the natural order.
+template <bool Strict>
+struct tails_linear_kernel<Strict, int, std::less<>> {
+  static size_t search(const int* tails, size_t n, const int& key,
+                       const std::less<>&) {
+    // strict counts the tails < key, non-strict those that are not > key
+    const __m128i bound = _mm_set1_epi32(key);
+    __m128i counts = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tails + i));
+      // each lane of the mask is -1 where the tail comes before key
+      const __m128i before = Strict
+        ? _mm_cmplt_epi32(t, bound)
+        : _mm_xor_si128(_mm_cmpgt_epi32(t, bound), _mm_set1_epi32(-1));
+      counts = _mm_sub_epi32(counts, before);
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), counts);
+    size_t count = size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) {
+      count += Strict ? tails[i] < key : tails[i] <= key;
+    }
+    return count;
+  }
+};
+#endif
+
+template <bool Strict, typename K, typename Ordering>
+inline size_t tails_linear_search(const K* tails, size_t n, const K& key,
+                                  const Ordering& ordering) {
+  return tails_linear_kernel<Strict, K, Ordering>::search(tails, n, key, ordering);
+}
+
+// Level of key in the sorted tails[0 .. n), using the kernel best suited to n.
+template <bool Strict, typename K, typename Ordering>
+inline size_t tails_search(const K* tails, size_t n, const K& key,
+                           const Ordering& ordering) {
+  return n <= TAILS_LINEAR_LIMIT
+    ? tails_linear_search<Strict>(tails, n, key, ordering)
+    : tails_binary_search<Strict>(tails, n, key, ordering);
+}
@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////////
+// work_stealing_pool.hpp
+//
+// A small persistent thread pool that runs parallel loops over an index
+// range. Each worker starts with an equal share of the range and consumes it
+// grain by grain from the front; a worker that runs dry steals the back half
+// of another worker's remaining share, so uneven per-index costs still keep
+// every core busy.
+//
+// How to use:
+//
+//    work_stealing_pool pool(4);
+//    pool.parallel_for(count, 64, [&](unsigned worker, size_t begin, size_t end) {
+//      for (size_t i = begin; i < end; ++i) { ... }
+//    });
+//
+// The calling thread takes part as worker 0, so a pool of size 1 runs the
+// loop inline. The loop body must not throw.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class work_stealing_pool {
+private:
+  // The not-yet-started part [begin, end) of one worker's share, padded so
+  // that neighbouring slots do not share a cache line.
+  struct range_slot {
+    std::mutex mutex;
+    size_t begin = 0, end = 0;
+    char padding[64];
+  };
+
+  // Type-erased loop body; the pointee lives on the caller's stack for the
+  // duration of parallel_for.
+  void (*_invoke)(void*, unsigned, size_t, size_t) = nullptr;
+  void* _body = nullptr;
+  size_t _grain = 1;
+
+  std::unique_ptr<range_slot[]> _slots;
+  std::vector<std::thread> _threads;
+
+  std::mutex _mutex;
+  std::condition_variable _start, _done;
+  unsigned long _generation = 0;
+  unsigned _active = 0;
+  bool _stopping = false;
+
+  // Take the next grain from worker's own share, or steal into it.
+  bool next_chunk(unsigned worker, size_t& begin, size_t& end) {
+    auto& own = _slots[worker];
+    {
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (own.begin < own.end) {
+        begin = own.begin;
+        end = std::min(own.end, own.begin + _grain);
+        own.begin = end;
+        return true;
+      }
+    }
+
+    const unsigned n = size();
+    for (unsigned k = 1; k < n; ++k) {
+      auto& victim = _slots[(worker + k) % n];
+      size_t stolen_begin, stolen_end;
+      {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.begin >= victim.end) {
+          continue;
+        }
+        const size_t remaining = victim.end - victim.begin;
+        stolen_end = victim.end;
+        stolen_begin = remaining > _grain ? victim.begin + remaining / 2 : victim.begin;
+        victim.end = stolen_begin;
+      }
+      begin = stolen_begin;
+      end = std::min(stolen_end, stolen_begin + _grain);
+      std::lock_guard<std::mutex> lock(own.mutex);
+      own.begin = end;
+      own.end = stolen_end;
+      return true;
+    }
+    return false;
+  }
+
+  void run_worker(unsigned worker) {
+    size_t begin, end;
+    while (next_chunk(worker, begin, end)) {
+      _invoke(_body, worker, begin, end);
+    }
+  }
+
+  void thread_main(unsigned worker) {
+    unsigned long seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _start.wait(lock, [&]() { return _stopping || _generation != seen; });
+        if (_stopping) {
+          return;
+        }
+        seen = _generation;
+      }
+
+      run_worker(worker);
+
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (--_active == 0) {
+        _done.notify_one();
+      }
+    }
+  }
+
+public:
+
+  // Create a pool with the given number of workers, including the calling
+  // thread. 0 means one worker per hardware thread.
+  explicit work_stealing_pool(unsigned workers = 0) {
+    if (workers == 0) {
+      workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _slots.reset(new range_slot[workers]);
+    for (unsigned w = 1; w < workers; ++w) {
+      _threads.emplace_back(&work_stealing_pool::thread_main, this, w);
+    }
+  }
+
+  work_stealing_pool(const work_stealing_pool&) = delete;
+  work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+  ~work_stealing_pool() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stopping = true;
+    }
+    _start.notify_all();
+    for (auto& t : _threads) {
+      t.join();
+    }
+  }
+
+  unsigned size() const {
+    return static_cast<unsigned>(_threads.size()) + 1;
+  }
+
+  // Call body(worker, begin, end) on disjoint chunks of at most grain indices
+  // that together cover [0, count), and return once every chunk has run.
+  // worker is in [0, size()) and no two concurrent calls share a worker
+  // index, so it can select per-thread scratch space.
+  template <typename Body>
+  void parallel_for(size_t count, size_t grain, Body&& body) {
+    assert(grain > 0);
+    if (count == 0) {
+      return;
+    }
+
+    const unsigned n = size();
+    if (n == 1) {
+      for (size_t begin = 0; begin < count; begin += grain) {
+        body(0u, begin, std::min(count, begin + grain));
+      }
+      return;
+    }
+
+    using body_type = typename std::remove_reference<Body>::type;
+    _invoke = [](void* b, unsigned worker, size_t begin, size_t end) {
+      (*static_cast<body_type*>(b))(worker, begin, end);
+    };
+    _body = const_cast<void*>(static_cast<const void*>(&body));
+    _grain = grain;
+    for (unsigned w = 0; w < n; ++w) {
+      _slots[w].begin = count * w / n;
+      _slots[w].end = count * (w + 1) / n;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _active = n - 1;
+      ++_generation;
+    }
+    _start.notify_all();
+
+    run_worker(0);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [&]() { return _active == 0; });
+  }
+};
@@ -13,48 +13,134 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
-#include <sstream>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
-#include <iostream>
 #include <ctime>
 
 // State of one disk, either light or dark.
 enum disk_color { DISK_LIGHT, DISK_DARK };
 
+// Number of set bits of x.
+inline unsigned popcount64(uint64_t x) {
+#ifdef __GNUC__
+  return __builtin_popcountll(x);
+#else
+  unsigned count = 0;
+  for (; x != 0; x &= x - 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
 // Data structure for the state of one row of disks.
+//
+// The row is bit-packed: disk i is bit i % 64 of word i / 64, set for a dark
+// disk and clear for a light one, so a disk takes one bit instead of a
+// whole disk_color. Bits past the last disk are always clear, which lets
+// whole words be compared. is_sorted and is_alternating check a word at a
+// time against masks of the expected pattern.
+//
+// A row starts in the alternating pattern, or from explicit colors, or from
+// packed words; random_disk_state and read_disk_state below build random
+// rows and rows stored in files.
 class disk_state {
+public:
+  static const size_t WORD_BITS = 64;
+
 private:
-  std::vector<disk_color> _colors;
+  // the alternating pattern DL DL ... within one word
+  static const uint64_t ALTERNATING_WORD = 0x5555555555555555ULL;
+
+  std::vector<uint64_t> _words;
+  size_t _count;
+
+  // Mask of the bits of word w that hold disks in [first, last).
+  static uint64_t range_mask(size_t w, size_t first, size_t last) {
+    const size_t word_first = w * WORD_BITS;
+    const size_t low = std::max(first, word_first) - word_first;
+    const size_t high = std::min(last, word_first + WORD_BITS) - word_first;
+    const uint64_t below_high = high == WORD_BITS ? ~uint64_t(0) : (uint64_t(1) << high) - 1;
+    return below_high & ~((uint64_t(1) << low) - 1);
+  }
+
+  // Return true when every disk in [first, last) has the given color.
+  bool all_colored(size_t first, size_t last, disk_color color) const {
+    if (first >= last) {
+      return true;
+    }
+    for (size_t w = first / WORD_BITS; w <= (last - 1) / WORD_BITS; ++w) {
+      const uint64_t mask = range_mask(w, first, last);
+      if ((_words[w] & mask) != (color == DISK_DARK ? mask : 0)) {
+        return false;
+      }
+    }
+    return true;
+  }
 
 public:
 
   disk_state(size_t light_count)
-    : _colors(light_count * 2, DISK_LIGHT) {
+    : _words((light_count * 2 + WORD_BITS - 1) / WORD_BITS, uint64_t(ALTERNATING_WORD)),
+      _count(light_count * 2) {
 
       assert(light_count > 0);
 
-      for (size_t i = 0; i < _colors.size(); i += 2) {
-        _colors[i] = DISK_DARK;
+      _words.back() &= range_mask(_words.size() - 1, 0, _count);
+  }
+
+  // A row with the given colors, which must not be empty.
+  explicit disk_state(const std::vector<disk_color>& colors)
+    : _words((colors.size() + WORD_BITS - 1) / WORD_BITS, 0),
+      _count(colors.size()) {
+
+      assert(!colors.empty());
+
+      for (size_t i = 0; i < _count; ++i) {
+        if (colors[i] == DISK_DARK) {
+          _words[i / WORD_BITS] |= uint64_t(1) << (i % WORD_BITS);
+        }
       }
   }
 
+  // A row of total_count disks from packed words in the layout above; bits
+  // past the last disk are ignored.
+  disk_state(const uint64_t* words, size_t total_count)
+    : _words(words, words + (total_count + WORD_BITS - 1) / WORD_BITS),
+      _count(total_count) {
+
+      assert(total_count > 0);
+
+      _words.back() &= range_mask(_words.size() - 1, 0, _count);
+  }
+
   // Equality operator for unit tests.
   bool operator== (const disk_state& rhs) const {
-    return std::equal(_colors.begin(), _colors.end(), rhs._colors.begin());
+    return _count == rhs._count && _words == rhs._words;
   }
 
   size_t total_count() const {
-    return _colors.size();
+    return _count;
   }
 
   size_t light_count() const {
-    return total_count() / 2;
+    return total_count() - dark_count();
   }
 
   size_t dark_count() const {
-    return light_count();
+    size_t darks = 0;
+    for (auto word : _words) {
+      darks += popcount64(word);
+    }
+    return darks;
   }
 
   bool is_index(size_t i) const {
@@ -63,58 +149,66 @@ public:
 
   disk_color get(size_t index) const {
     assert(is_index(index));
-    return _colors[index];
+    return (_words[index / WORD_BITS] >> (index % WORD_BITS)) & 1 ? DISK_DARK : DISK_LIGHT;
   }
 
   void swap(size_t left_index) {
     assert(is_index(left_index));
     auto right_index = left_index + 1;
     assert(is_index(right_index));
-    std::swap(_colors[left_index], _colors[right_index]);
+    if (get(left_index) != get(right_index)) {   // flip both disks
+      _words[left_index / WORD_BITS] ^= uint64_t(1) << (left_index % WORD_BITS);
+      _words[right_index / WORD_BITS] ^= uint64_t(1) << (right_index % WORD_BITS);
+    }
   }
 
-  std::string to_string() const {
-    std::stringstream ss;
-    bool first = true;
-    for (auto color : _colors) {
-      if (!first) {
-        ss << " ";
-      }
+  // Raw access to the packed words, for word-parallel algorithms. Bits
+  // past the last disk must be left clear.
+  size_t word_count() const {
+    return _words.size();
+  }
 
-      if (color == DISK_LIGHT) {
-        ss << "L";
-      } else {
-        ss << "D";
-      }
+  uint64_t* words() {
+    return _words.data();
+  }
+
+  const uint64_t* words() const {
+    return _words.data();
+  }
 
-      first = false;
+  std::string to_string() const {
+    std::string result;
+    result.reserve(2 * _count);
+    for (size_t i = 0; i < _count; ++i) {
+      if (i > 0) {
+        result.push_back(' ');
+      }
+      result.push_back(get(i) == DISK_LIGHT ? 'L' : 'D');
     }
-    return ss.str();
+    return result;
   }
 
   // Return true when this disk_state is in alternating format. That means
   // that the first disk at index 0 is dark, the second disk at index 1
   // is light, and so on for the entire row of disks.
   bool is_alternating() const {
-    for (size_t i = 0; i < _colors.size(); i += 2) {
-        if (!(_colors[i] == DISK_DARK && _colors[i+1] == DISK_LIGHT)) return false;     // every 2 disks must follow the same light-dark pattern as the previous 2
+    if (_count % 2) {   // the pattern comes in pairs
+      return false;
     }
-    return true;    // alternating = true if it makes it to the end of the check
+    for (size_t w = 0; w < _words.size(); ++w) {
+      if (_words[w] != (ALTERNATING_WORD & range_mask(w, 0, _count))) {
+        return false;
+      }
+    }
+    return true;
   }
 
   // Return true when this disk_state is fully sorted, with all light disks
   // on the left (low indices) and all dark disks on the right (high
   // indices).
   bool is_sorted() const {
-    if (_colors.size() % 2 ){   // odd number of disks cannot be sorted
-      return false;
-    }
-    auto n = _colors.size();
-    for (size_t i = 0; i < n/2; i ++) 
-    {
-        if (_colors[i] == DISK_DARK || _colors[i + n/2] == DISK_LIGHT) return false;    // the first n/2 disks must be light, and second n/2 disks must be dark
-    }
-    return true;    // sorted = true if it makes it to the end of the check
+    const size_t lights = light_count();
+    return all_colored(0, lights, DISK_LIGHT) && all_colored(lights, _count, DISK_DARK);
   }
 };
 
@@ -124,101 +218,395 @@ public:
 class sorted_disks {
 private:
   disk_state _after;
-  unsigned _swap_count;
+  uint64_t _swap_count;   // 64 bits: n(n+1)/2 swaps overflow 32 bits past n = 92681
 
 public:
 
-  sorted_disks(const disk_state& after, unsigned swap_count)
+  sorted_disks(const disk_state& after, uint64_t swap_count)
     : _after(after), _swap_count(swap_count) { }
 
-  sorted_disks(disk_state&& after, unsigned swap_count)
-    : _after(after), _swap_count(swap_count) { }
+  sorted_disks(disk_state&& after, uint64_t swap_count)
+    : _after(std::move(after)), _swap_count(swap_count) { }
 
   const disk_state& after() const {
     return _after;
   }
 
-  unsigned swap_count() const {
+  uint64_t swap_count() const {
     return _swap_count;
   }
 };
 
+// A pseudorandom row of total_count disks, using the given seed, of which
+// light_fraction (rounded to the nearest disk) are light.
+disk_state random_disk_state(size_t total_count, double light_fraction, unsigned seed) {
+  assert(total_count > 0);
+  assert(0.0 <= light_fraction && light_fraction <= 1.0);
+
+  const size_t lights = size_t(light_fraction * total_count + 0.5);
+  std::vector<disk_color> colors(total_count, DISK_DARK);
+  std::fill(colors.begin(), colors.begin() + lights, DISK_LIGHT);
+
+  std::mt19937 gen(seed);
+  std::shuffle(colors.begin(), colors.end(), gen);
+  return disk_state(colors);
+}
+
+// Binary row files (all integers little-endian):
+//
+//    offset  size  field
+//         0     4  magic "DSKS"
+//         4     4  version, currently 1
+//         8     8  number of disks
+//        16        the packed words, eight bytes each
+//
+// I/O failures and malformed files are reported with std::runtime_error.
+const char DISK_FILE_MAGIC[4] = {'D', 'S', 'K', 'S'};
+const uint32_t DISK_FILE_VERSION = 1;
+
+void write_disk_state(const std::string& path, const disk_state& row) {
+  std::vector<unsigned char> bytes(DISK_FILE_MAGIC, DISK_FILE_MAGIC + 4);
+  auto put = [&](uint64_t x, size_t size) {
+    for (size_t b = 0; b < size; ++b, x >>= 8) {
+      bytes.push_back(static_cast<unsigned char>(x & 0xff));
+    }
+  };
+  put(DISK_FILE_VERSION, 4);
+  put(row.total_count(), 8);
+  for (size_t w = 0; w < row.word_count(); ++w) {
+    put(row.words()[w], 8);
+  }
+
+  std::FILE* out = std::fopen(path.c_str(), "wb");
+  bool written = out && std::fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+  if (out) {
+    written = std::fclose(out) == 0 && written;
+  }
+  if (!written) {
+    throw std::runtime_error("disk I/O: cannot write " + path);
+  }
+}
+
+disk_state read_disk_state(const std::string& path) {
+  std::FILE* in = std::fopen(path.c_str(), "rb");
+  if (!in) {
+    throw std::runtime_error("disk I/O: cannot open " + path);
+  }
+  std::vector<unsigned char> bytes;
+  unsigned char buffer[1 << 16];
+  size_t got;
+  while ((got = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + got);
+  }
+  const bool failed = std::ferror(in) != 0;
+  std::fclose(in);
+  if (failed) {
+    throw std::runtime_error("disk I/O: cannot read " + path);
+  }
+
+  auto get = [&](size_t offset, size_t size) {
+    uint64_t x = 0;
+    for (size_t b = size; b-- > 0; ) {
+      x = (x << 8) | bytes[offset + b];
+    }
+    return x;
+  };
+  if (bytes.size() < 16 || std::memcmp(bytes.data(), DISK_FILE_MAGIC, 4) != 0) {
+    throw std::runtime_error("disk I/O: not a disk row file " + path);
+  }
+  if (get(4, 4) != DISK_FILE_VERSION) {
+    throw std::runtime_error("disk I/O: unsupported version");
+  }
+  const uint64_t count = get(8, 8);
+  const uint64_t word_count = count / disk_state::WORD_BITS + (count % disk_state::WORD_BITS != 0);
+  if (count == 0 || (bytes.size() - 16) / 8 != word_count || (bytes.size() - 16) % 8 != 0) {
+    throw std::runtime_error("disk I/O: malformed disk row file " + path);
+  }
+  std::vector<uint64_t> words(word_count);
+  for (size_t w = 0; w < word_count; ++w) {
+    words[w] = get(16 + 8 * w, 8);
+  }
+  return disk_state(words.data(), count);
+}
+
+// Observer policies for the sorting algorithms. An observer is told when a
+// sort starts, when each pass ends with the swaps it made, when the sort
+// stops early because a pass made no swaps, and when it finishes. An
+// observer may also define swapped(i), called after every swap(i); the
+// ones that do not are never called per swap. The default no_observer does
+// nothing, so with it the algorithms compile down to their plain loops.
+struct no_observer {
+  void start(size_t /* disk_count */) { }
+  void pass_done(size_t /* pass */, uint64_t /* swaps */) { }
+  void early_exit(size_t /* pass */) { }
+  void finish(uint64_t /* swap_count */) { }
+};
+
+// Call observer.swapped(left_index) when the observer has that hook.
+template <typename Observer>
+auto notify_swap(Observer& observer, size_t left_index, int)
+  -> decltype(observer.swapped(left_index), void()) {
+  observer.swapped(left_index);
+}
+
+template <typename Observer>
+void notify_swap(Observer&, size_t, long) { }
+
+// Observer that records the passes and measures wall-clock and CPU time.
+struct timing_observer {
+  size_t disk_count = 0;
+  std::vector<uint64_t> swaps_per_pass;
+  size_t early_exit_pass = 0;   // 0 when the sort ran every pass
+  double wall_seconds = 0, cpu_seconds = 0;
+
+  void start(size_t disks) {
+    disk_count = disks;
+    swaps_per_pass.clear();
+    early_exit_pass = 0;
+    _wall_start = std::chrono::steady_clock::now();
+    _cpu_start = std::clock();
+  }
+
+  void pass_done(size_t /* pass */, uint64_t swaps) {
+    swaps_per_pass.push_back(swaps);
+  }
+
+  void early_exit(size_t pass) {
+    early_exit_pass = pass;
+  }
+
+  void finish(uint64_t /* swap_count */) {
+    cpu_seconds = (std::clock() - _cpu_start) / (double) CLOCKS_PER_SEC;
+    wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _wall_start).count();
+  }
+
+  size_t pass_count() const {
+    return swaps_per_pass.size();
+  }
+
+private:
+  std::chrono::steady_clock::time_point _wall_start;
+  std::clock_t _cpu_start = 0;
+};
+
 // Algorithm that sorts disks using the left-to-right algorithm.
-sorted_disks sort_left_to_right(const disk_state& before) {
+template <typename Observer>
+sorted_disks sort_left_to_right(const disk_state& before, Observer& observer) {
   disk_state L = before;
   const auto n = L.total_count();
-  auto nswaps = 0;
-  std::clock_t start;
-  double duration;
+  uint64_t nswaps = 0;
 
-  start = std::clock();
+  observer.start(n);
   for (size_t k = 1; k < n; k++)      // runs up to as many times as there are disks
   {
-    bool swapped = false;
+    uint64_t pass_swaps = 0;
     for (size_t i = 0; i < n-k; i++)      // range of indices that could be unsorted shrinks as the sorting progresses
     {
         if (L.get(i) == DISK_DARK && L.get(i+1) == DISK_LIGHT) {      // move light disks toward the left and dark disks toward the right as needed
           L.swap(i);
-          swapped = true;
-          nswaps++;     // swap counter increment
+          notify_swap(observer, i, 0);
+          pass_swaps++;     // swap counter increment
         }
     }
-    if (!swapped) {
-      duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
-
-      std::cout<< n << " disks: "<< duration << " seconds" <<'\n';
-      return sorted_disks(L, nswaps);     // early exit if no swaps were made in a loop cycle (already sorted)
+    nswaps += pass_swaps;
+    observer.pass_done(k, pass_swaps);
+    if (pass_swaps == 0) {
+      observer.early_exit(k);
+      break;      // early exit if no swaps were made in a loop cycle (already sorted)
     }
   }
-  duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
-
-  std::cout<< n <<" disks:"<< duration << " seconds" <<'\n';
+  observer.finish(nswaps);
   return sorted_disks(L, nswaps);     // return the sorted disks and swap counter
 }
 
-// Algorithm that sorts disks using the lawnmower algorithm.
-sorted_disks sort_lawnmower(const disk_state& before) {
+sorted_disks sort_left_to_right(const disk_state& before) {
+  no_observer observer;
+  return sort_left_to_right(before, observer);
+}
+
+// Algorithm that sorts disks using the lawnmower algorithm. Each sweep, in
+// either direction, is one pass for the observer.
+template <typename Observer>
+sorted_disks sort_lawnmower(const disk_state& before, Observer& observer) {
   disk_state L = before;
   const auto n = L.total_count();
-  auto nswaps = 0;
-  std::clock_t start;
-  double duration;
+  uint64_t nswaps = 0;
+  size_t pass = 0;
 
-  start = std::clock();
-  for (size_t k = 1; k < n/2; k++)      // runs up to (n/2 - 1) times
+  observer.start(n);
+  for (size_t k = 1; 2*k <= n; k++)      // runs up to n/2 times; after round k the first k and last k disks are final
   {
-    bool swapped = false;
-    for (size_t i = 0; i < n - 2*k + 1; i++)      // lawnmower going left to right; range of indices that could be unsorted shrinks as the sorting progresses
+    uint64_t pass_swaps = 0;
+    for (size_t i = k - 1; i < n - k; i++)      // lawnmower going left to right; range of indices that could be unsorted shrinks as the sorting progresses
     {
         if (L.get(i) == DISK_DARK && L.get(i+1) == DISK_LIGHT) {      // move light disks toward the left and dark disks toward the right as needed
           L.swap(i);
-          swapped = true;
-          nswaps++;     // swap counter increment
+          notify_swap(observer, i, 0);
+          pass_swaps++;     // swap counter increment
         }
     }
-    if (!swapped) {
-      duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
-
-      std::cout<< n << " disks: "<< duration << " seconds" <<'\n';
-      return sorted_disks(L, nswaps);
+    nswaps += pass_swaps;
+    observer.pass_done(++pass, pass_swaps);
+    if (pass_swaps == 0) {
+      observer.early_exit(pass);
+      break;
     }
-    for (size_t i = n - 2*k; i > 1; i--)          // lawnmower going right to left; range of indices that could be unsorted shrinks as the sorting progresses
+
+    pass_swaps = 0;
+    for (size_t i = n - k - 1; i >= k; i--)          // lawnmower going right to left; range of indices that could be unsorted shrinks as the sorting progresses
     {
         if (L.get(i-1) == DISK_DARK && L.get(i) == DISK_LIGHT) {      // move light disks toward the left and dark disks toward the right as needed
           L.swap(i-1);
-          swapped = true;
-          nswaps++;     // swap counter increment
+          notify_swap(observer, i-1, 0);
+          pass_swaps++;     // swap counter increment
         }
     }
-    if (!swapped) {
-      duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
+    nswaps += pass_swaps;
+    observer.pass_done(++pass, pass_swaps);
+    if (pass_swaps == 0) {
+      observer.early_exit(pass);
+      break;      // early exit if no swaps were made in a loop cycle (already sorted)
+    }
+  }
+  observer.finish(nswaps);
+  return sorted_disks(L, nswaps);     // return the sorted disks and swap counter
+}
+
+sorted_disks sort_lawnmower(const disk_state& before) {
+  no_observer observer;
+  return sort_lawnmower(before, observer);
+}
 
-      std::cout<< n << " disks: "<< duration << " seconds" <<'\n';
-      return sorted_disks(L, nswaps);     // early exit if no swaps were made in a loop cycle (already sorted)
+// One round of the word-parallel algorithm: swap every dark disk that has a
+// light disk on its right, all at once. Such DL pairs can never overlap (the
+// right disk of one would have to be dark to start the next), so every pair
+// is a separate swap. Returns the number of swaps.
+inline size_t swap_all_dark_light(disk_state& L) {
+  const size_t WORD_BITS = disk_state::WORD_BITS;
+  uint64_t* words = L.words();
+  const size_t word_count = L.word_count();
+  // a disk can only start a pair when there is a disk to its right
+  const size_t last_start = L.total_count() - 1;
+
+  size_t swaps = 0;
+  uint64_t carry = 0;   // bit 0 flip owed by the previous word's bit 63 swap
+  for (size_t w = 0; w < word_count; ++w) {
+    const uint64_t x = words[w];
+    const uint64_t next = w + 1 < word_count ? words[w + 1] : 0;
+    // bit i set: disk i is dark and disk i + 1 is light
+    uint64_t starts = x & ~((x >> 1) | (next << (WORD_BITS - 1)));
+    if (last_start < (w + 1) * WORD_BITS) {
+      const size_t valid = last_start - w * WORD_BITS;   // bits [0, valid) may start
+      starts &= valid == 0 ? 0 : ~uint64_t(0) >> (WORD_BITS - valid);
     }
+    words[w] = x ^ starts ^ (starts << 1) ^ carry;
+    carry = starts >> (WORD_BITS - 1);
+    swaps += popcount64(starts);
   }
-  duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
+  return swaps;
+}
 
-  std::cout<< n << " disks: "<< duration << " seconds" <<'\n';
-  return sorted_disks(L, nswaps);     // return the sorted disks and swap counter
+// Algorithm that sorts disks with word-parallel swap rounds: each round
+// applies every available "DL -> LD" swap across the packed row with a few
+// bit operations per 64 disks, until a round finds nothing to swap. Every
+// swap removes exactly one dark-before-light pair, like the swaps of the
+// other algorithms, so the swap count matches theirs.
+sorted_disks sort_word_parallel(const disk_state& before) {
+  disk_state L = before;
+  uint64_t nswaps = 0;
+  while (true) {
+    const size_t swaps = swap_all_dark_light(L);
+    if (swaps == 0) {
+      break;
+    }
+    nswaps += swaps;
+  }
+  return sorted_disks(L, nswaps);
+}
+
+// Number of dark disks that are left of a light disk, counted over all
+// pairs. Every swap of the sorting algorithms removes exactly one such
+// pair, so this is the swap count they all arrive at, on any row. One
+// pass over the packed words: each light disk adds the dark disks before
+// it, which is the darks of the earlier words plus a popcount within its
+// own word.
+uint64_t count_dark_light_inversions(const disk_state& row) {
+  const size_t WORD_BITS = disk_state::WORD_BITS;
+  const uint64_t* words = row.words();
+  const size_t n = row.total_count();
+
+  uint64_t inversions = 0, darks_before = 0;
+  for (size_t w = 0; w < row.word_count(); ++w) {
+    const size_t bits = std::min(WORD_BITS, n - w * WORD_BITS);
+    const uint64_t valid = bits == WORD_BITS ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    const uint64_t x = words[w];
+    uint64_t lights = ~x & valid;
+    inversions += darks_before * popcount64(lights);
+    for (; lights != 0; lights &= lights - 1) {
+      const uint64_t below = (lights & (0 - lights)) - 1;   // bits under the lowest light
+      inversions += popcount64(x & below);
+    }
+    darks_before += popcount64(x);
+  }
+  return inversions;
+}
+
+// Number of passes sort_left_to_right makes on row, early exit included.
+// A pass carries each dark disk right past a whole run of light disks, but
+// moves every light disk left by at most one place, so the light disk with
+// the most dark disks before it (always the last light disk) sets the
+// count: one pass per such dark disk, plus the empty pass that detects the
+// sorted row, capped by the n - 1 passes of the outer loop.
+size_t predicted_left_to_right_passes(const disk_state& row) {
+  const size_t WORD_BITS = disk_state::WORD_BITS;
+  const uint64_t* words = row.words();
+  const size_t n = row.total_count();
+
+  // darks before the last light disk, if there is one
+  size_t darks_before_last_light = 0, darks = 0;
+  for (size_t w = 0; w < row.word_count(); ++w) {
+    const size_t bits = std::min(WORD_BITS, n - w * WORD_BITS);
+    const uint64_t valid = bits == WORD_BITS ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    const uint64_t x = words[w];
+    uint64_t lights = ~x & valid;
+    if (lights != 0) {
+      size_t last = 0;
+      while (lights >>= 1) {
+        ++last;
+      }
+      const uint64_t below = last == 0 ? 0 : ~uint64_t(0) >> (WORD_BITS - last);
+      darks_before_last_light = darks + popcount64(x & below);
+    }
+    darks += popcount64(x);
+  }
+  return std::min(darks_before_last_light + 1, n - 1);
+}
+
+// Analytical solver: the sorted row has every light disk before every dark
+// disk, and the swap count is the inversion count, so both come from one
+// O(n) pass over the packed words without simulating any swaps. Agrees
+// with sort_left_to_right on every input.
+sorted_disks sort_analytical(const disk_state& before) {
+  const size_t WORD_BITS = disk_state::WORD_BITS;
+  const uint64_t swaps = count_dark_light_inversions(before);
+
+  const size_t darks = before.dark_count();
+
+  // lights in [0, n - darks), darks in [n - darks, n)
+  disk_state L = before;
+  const size_t n = L.total_count(), first_dark = n - darks;
+  uint64_t* words = L.words();
+  for (size_t w = 0; w < L.word_count(); ++w) {
+    const size_t word_first = w * WORD_BITS;
+    const size_t bits = std::min(WORD_BITS, n - word_first);
+    const uint64_t valid = bits == WORD_BITS ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    if (first_dark <= word_first) {
+      words[w] = valid;
+    } else if (first_dark >= word_first + bits) {
+      words[w] = 0;
+    } else {
+      words[w] = valid & ~((uint64_t(1) << (first_dark - word_first)) - 1);
+    }
+  }
+  return sorted_disks(std::move(L), swaps);
 }
@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////
+// disks_parallel.hpp
+//
+// Parallel odd-even transposition sort for rows of disks.
+//
+// Each phase looks at disjoint pairs only, (0,1) (2,3) ... in even phases
+// and (1,2) (3,4) ... in odd phases, and swaps every dark-light pair among
+// them at once. On the packed row one phase is a few bit operations per
+// word, with the pair starts selected by an even or odd bit mask. The words
+// are split into contiguous blocks, one per thread, and the threads run the
+// phases in lockstep, separated by a barrier. Every phase reads the row
+// from one buffer and writes it to another, so a thread may read the words
+// next to its block while their owners rewrite them. The row is sorted
+// once an even and an odd phase in a row find nothing to swap.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "disks.hpp"
+
+// Output of the odd-even transposition sort: the sorted_disks, plus the
+// number of phases up to the last one that swapped anything.
+class phased_sorted_disks : public sorted_disks {
+private:
+  uint64_t _phase_count;
+
+public:
+
+  phased_sorted_disks(disk_state&& after, uint64_t swap_count, uint64_t phase_count)
+    : sorted_disks(std::move(after), swap_count), _phase_count(phase_count) { }
+
+  uint64_t phase_count() const {
+    return _phase_count;
+  }
+};
+
+// Reusable barrier for a fixed number of threads (std::barrier is C++20).
+class phase_barrier {
+private:
+  std::mutex _mutex;
+  std::condition_variable _released;
+  size_t _threads, _waiting = 0, _generation = 0;
+
+public:
+
+  explicit phase_barrier(size_t threads)
+    : _threads(threads) { }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    const size_t generation = _generation;
+    if (++_waiting == _threads) {
+      _waiting = 0;
+      ++_generation;
+      _released.notify_all();
+    } else {
+      _released.wait(lock, [&]() { return generation != _generation; });
+    }
+  }
+};
+
+// Run one phase over words [first, last) of src, writing them to dst.
+// parity is 0 for an even phase and 1 for an odd one. Returns the number of
+// swaps.
+inline uint64_t transposition_phase(const uint64_t* src, uint64_t* dst,
+                                    size_t word_count, size_t total_count,
+                                    size_t first, size_t last, unsigned parity) {
+  const size_t WORD_BITS = disk_state::WORD_BITS;
+  const uint64_t pair_starts = parity == 0 ? 0x5555555555555555ULL : 0xAAAAAAAAAAAAAAAAULL;
+  const size_t last_start = total_count - 1;
+
+  uint64_t swaps = 0;
+  for (size_t w = first; w < last; ++w) {
+    const uint64_t x = src[w];
+    const uint64_t next = w + 1 < word_count ? src[w + 1] : 0;
+    uint64_t starts = x & ~((x >> 1) | (next << (WORD_BITS - 1))) & pair_starts;
+    if (last_start < (w + 1) * WORD_BITS) {
+      const size_t valid = last_start - w * WORD_BITS;
+      starts &= valid == 0 ? 0 : ~uint64_t(0) >> (WORD_BITS - valid);
+    }
+
+    // an odd phase also pairs bit 63 of the previous word with bit 0
+    uint64_t incoming = 0;
+    if (parity == 1 && w > 0) {
+      incoming = (src[w - 1] >> (WORD_BITS - 1)) & ~x & 1;
+    }
+
+    dst[w] = x ^ starts ^ (starts << 1) ^ incoming;
+    swaps += popcount64(starts);
+  }
+  return swaps;
+}
+
+// Sort with the odd-even transposition algorithm on the given number of
+// threads (0 for one per core).
+phased_sorted_disks sort_odd_even(const disk_state& before, unsigned threads = 0) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  disk_state L = before;
+  const size_t word_count = L.word_count(), total_count = L.total_count();
+  threads = unsigned(std::min<size_t>(threads, word_count));
+
+  std::vector<uint64_t> other(L.words(), L.words() + word_count);
+  uint64_t* buffers[2] = {L.words(), other.data()};
+
+  // swaps of each thread, in separate slots for even and odd phases so a
+  // slot is never rewritten while another thread may still read it
+  std::vector<uint64_t> phase_swaps[2] = {std::vector<uint64_t>(threads),
+                                          std::vector<uint64_t>(threads)};
+  phase_barrier barrier(threads);
+  uint64_t total_swaps = 0, phase_count = 0;
+  size_t final_buffer = 0;
+
+  auto worker = [&](unsigned t) {
+    const size_t first = word_count * t / threads, last = word_count * (t + 1) / threads;
+    size_t from = 0;
+    uint64_t idle_phases = 0, swaps = 0, phases = 0;
+    for (uint64_t phase = 0; idle_phases < 2; ++phase) {
+      const unsigned parity = unsigned(phase % 2);
+      phase_swaps[parity][t] = transposition_phase(buffers[from], buffers[1 - from],
+                                                   word_count, total_count,
+                                                   first, last, parity);
+      barrier.wait();
+
+      uint64_t swapped = 0;
+      for (auto s : phase_swaps[parity]) {
+        swapped += s;
+      }
+      from = 1 - from;
+      if (swapped == 0) {
+        ++idle_phases;
+      } else {
+        idle_phases = 0;
+        swaps += swapped;
+        phases = phase + 1;
+      }
+    }
+    if (t == 0) {
+      total_swaps = swaps;
+      phase_count = phases;
+      final_buffer = from;
+    }
+  };
+
+  std::vector<std::thread> helpers;
+  for (unsigned t = 1; t < threads; ++t) {
+    helpers.emplace_back(worker, t);
+  }
+  worker(0);
+  for (auto& helper : helpers) {
+    helper.join();
+  }
+
+  if (final_buffer == 1) {
+    std::copy(other.begin(), other.end(), L.words());
+  }
+  return phased_sorted_disks(std::move(L), total_swaps, phase_count);
+}
@@ -6,10 +6,13 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <cassert>
+#include <numeric>
 
 #include "rubrictest.hpp"
 
 #include "disks.hpp"
+#include "disks_parallel.hpp"
+#include "disks_trace.hpp"
 
 int main() {
 
@@ -156,5 +159,250 @@ int main() {
              TEST_EQUAL("n=100 gives 5050 swaps", 5050, trial(100));
            });
 
+  rubric.criterion("bit-packed storage", 1,
+     		   [&]() {
+             // 80 disks span two words
+             const disk_state alt_forty(40);
+             auto crossed(alt_forty);
+             crossed.swap(63);
+             TEST_EQUAL("get(63) after swap across words", DISK_DARK, crossed.get(63));
+             TEST_EQUAL("get(64) after swap across words", DISK_LIGHT, crossed.get(64));
+             TEST_FALSE("is_alternating() after swap across words", crossed.is_alternating());
+             crossed.swap(63);
+             TEST_EQUAL("swapped back", alt_forty, crossed);
+             TEST_TRUE("is_alternating() for n=40", alt_forty.is_alternating());
+             TEST_EQUAL("to_string()", "D L D L D L", alt_three.to_string());
+
+             auto sorted_forty = sort_left_to_right(alt_forty).after();
+             TEST_TRUE("is_sorted() for n=40", sorted_forty.is_sorted());
+             sorted_forty.swap(39);
+             TEST_FALSE("is_sorted() after swap at the middle", sorted_forty.is_sorted());
+
+             // 2^27 disks in 16 MiB
+             const disk_state large(size_t(1) << 26);
+             TEST_TRUE("is_alternating() for 2^27 disks", large.is_alternating());
+             TEST_FALSE("is_sorted() for 2^27 disks", large.is_sorted());
+           });
+
+  rubric.criterion("word-parallel, same swaps", 1,
+     		   [&]() {
+             auto trial = [](unsigned n) {
+               auto output = sort_word_parallel(disk_state(n));
+               TEST_TRUE("actually sorted", output.after().is_sorted());
+               return output.swap_count();
+             };
+
+             TEST_EQUAL("n=1 gives 1 swap", 1, trial(1));
+             TEST_EQUAL("n=3 gives 6 swaps", 6, trial(3));
+             TEST_EQUAL("n=4 gives 10 swaps", 10, trial(4));
+             TEST_EQUAL("n=32 gives 528 swaps", 528, trial(32));
+             TEST_EQUAL("n=33 gives 561 swaps", 561, trial(33));
+             TEST_EQUAL("n=100 gives 5050 swaps", 5050, trial(100));
+             TEST_EQUAL("n=1000 gives 500500 swaps", 500500, trial(1000));
+             TEST_EQUAL("same final state", sort_lawnmower(disk_state(70)).after(),
+                        sort_word_parallel(disk_state(70)).after());
+           });
+
+  rubric.criterion("analytical solver", 1,
+     		   [&]() {
+             for (unsigned n : {1, 3, 4, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100}) {
+               auto simulated = sort_left_to_right(disk_state(n));
+               auto analytical = sort_analytical(disk_state(n));
+               TEST_EQUAL("same final state", simulated.after(), analytical.after());
+               TEST_EQUAL("same swap count", simulated.swap_count(), analytical.swap_count());
+             }
+
+             // a nearly sorted row of 80 disks, which spans two words
+             auto partial = sort_word_parallel(disk_state(40)).after();
+             partial.swap(39);
+             partial.swap(38);
+             TEST_EQUAL("partial final state", sort_left_to_right(partial).after(),
+                        sort_analytical(partial).after());
+             TEST_EQUAL("partial swap count", sort_left_to_right(partial).swap_count(),
+                        sort_analytical(partial).swap_count());
+
+             // n(n+1)/2 needs more than 32 bits
+             auto large = sort_analytical(disk_state(1000000));
+             TEST_TRUE("large sorted", large.after().is_sorted());
+             TEST_EQUAL("large swap count", uint64_t(500000500000), large.swap_count());
+           });
+
+  rubric.criterion("odd-even transposition", 1,
+     		   [&]() {
+             for (unsigned n : {1, 3, 4, 31, 32, 33, 100, 1000}) {
+               const disk_state before(n);
+               const uint64_t expected = uint64_t(n) * (n + 1) / 2;
+               for (unsigned threads : {1, 2, 3, 8}) {
+                 auto output = sort_odd_even(before, threads);
+                 TEST_TRUE("actually sorted", output.after().is_sorted());
+                 TEST_EQUAL("swap count", expected, output.swap_count());
+                 TEST_EQUAL("phase count", uint64_t(n), output.phase_count());
+               }
+             }
+
+             auto partial = sort_analytical(disk_state(40)).after();
+             partial.swap(39);
+             auto output = sort_odd_even(partial, 2);
+             TEST_EQUAL("nearly sorted swaps", uint64_t(1), output.swap_count());
+             TEST_EQUAL("nearly sorted phases", uint64_t(2), output.phase_count());
+           });
+
+  rubric.criterion("observer hooks", 1,
+     		   [&]() {
+             timing_observer left;
+             auto output = sort_left_to_right(disk_state(10), left);
+             TEST_EQUAL("disk count", size_t(20), left.disk_count);
+             TEST_EQUAL("swaps per pass add up", output.swap_count(),
+                        std::accumulate(left.swaps_per_pass.begin(), left.swaps_per_pass.end(), uint64_t(0)));
+             TEST_EQUAL("first pass swaps", uint64_t(10), left.swaps_per_pass.front());
+             TEST_TRUE("time measured", left.wall_seconds >= 0 && left.cpu_seconds >= 0);
+
+             timing_observer mower;
+             output = sort_lawnmower(disk_state(10), mower);
+             TEST_EQUAL("lawnmower swaps per pass add up", output.swap_count(),
+                        std::accumulate(mower.swaps_per_pass.begin(), mower.swaps_per_pass.end(), uint64_t(0)));
+
+             // an already sorted row stops after one empty pass
+             timing_observer sorted;
+             sort_left_to_right(sorted_three, sorted);
+             TEST_EQUAL("sorted pass count", size_t(1), sorted.pass_count());
+             TEST_EQUAL("sorted early exit", size_t(1), sorted.early_exit_pass);
+
+             // any type with the four hooks is an observer
+             struct counting_observer {
+               size_t starts = 0, passes = 0, finishes = 0;
+               void start(size_t) { ++starts; }
+               void pass_done(size_t, uint64_t) { ++passes; }
+               void early_exit(size_t) { }
+               void finish(uint64_t) { ++finishes; }
+             } counter;
+             sort_lawnmower(disk_state(5), counter);
+             timing_observer same_row;
+             sort_lawnmower(disk_state(5), same_row);
+             TEST_EQUAL("custom observer", size_t(1), counter.starts);
+             TEST_EQUAL("custom observer passes", same_row.pass_count(), counter.passes);
+             TEST_EQUAL("custom observer finish", size_t(1), counter.finishes);
+           });
+
+  rubric.criterion("arbitrary rows", 1,
+           [&]() {
+             const disk_state dld(std::vector<disk_color>{DISK_DARK, DISK_LIGHT, DISK_DARK});
+             TEST_EQUAL("explicit colors", std::string("D L D"), dld.to_string());
+             TEST_EQUAL("explicit light count", size_t(1), dld.light_count());
+             TEST_FALSE("explicit unsorted", dld.is_sorted());
+             TEST_TRUE("lights first is sorted", sort_lawnmower(dld).after().is_sorted());
+
+             for (unsigned seed = 0; seed < 200; ++seed) {
+               const auto row = random_disk_state(1 + seed % 150, (seed % 5) / 4.0, seed);
+               const uint64_t inversions = count_dark_light_inversions(row);
+               TEST_EQUAL("random light count", size_t((seed % 5) / 4.0 * row.total_count() + 0.5),
+                          row.light_count());
+
+               const auto left = sort_left_to_right(row);
+               TEST_TRUE("left-to-right sorts", left.after().is_sorted());
+               TEST_EQUAL("left-to-right swaps", inversions, left.swap_count());
+               const auto mower = sort_lawnmower(row);
+               TEST_TRUE("lawnmower sorts", mower.after().is_sorted());
+               TEST_EQUAL("lawnmower swaps", inversions, mower.swap_count());
+               TEST_EQUAL("word-parallel", left.after(), sort_word_parallel(row).after());
+               TEST_EQUAL("analytical", left.after(), sort_analytical(row).after());
+               TEST_EQUAL("odd-even swaps", inversions, sort_odd_even(row, 2).swap_count());
+
+               timing_observer observer;
+               sort_left_to_right(row, observer);
+               TEST_EQUAL("predicted passes", predicted_left_to_right_passes(row),
+                          observer.pass_count());
+
+               TEST_EQUAL("packed round trip", row, disk_state(row.words(), row.total_count()));
+             }
+
+             const auto row = random_disk_state(1000, 0.3, 7);
+             const std::string path = "disks_test_row.bin";
+             write_disk_state(path, row);
+             TEST_EQUAL("file round trip", row, read_disk_state(path));
+             std::remove(path.c_str());
+
+             bool threw = false;
+             try {
+               read_disk_state("no_such_disk_row.bin");
+             } catch (const std::runtime_error&) {
+               threw = true;
+             }
+             TEST_TRUE("missing file throws", threw);
+           });
+
+  rubric.criterion("swap traces", 1,
+           [&]() {
+             const auto row = random_disk_state(300, 0.5, 11);
+             trace_recorder recorder(row);
+             const auto output = sort_left_to_right(row, recorder);
+
+             const swap_trace trace(recorder.bytes(), 37);
+             TEST_EQUAL("trace before", row, trace.before());
+             TEST_EQUAL("trace after", output.after(), trace.after());
+             TEST_EQUAL("trace swaps", output.swap_count(), trace.swap_count());
+             TEST_EQUAL("trace passes", predicted_left_to_right_passes(row), trace.pass_count());
+             TEST_TRUE("about a byte per swap",
+                       recorder.bytes().size() < TRACE_HEADER_SIZE + 8 * row.word_count() +
+                                                 2 * trace.swap_count() + trace.pass_count());
+
+             // rerun the sort, comparing random access replays with the live row
+             struct replay_checker : no_observer {
+               const swap_trace& trace;
+               disk_state row;
+               uint64_t swaps = 0;
+               bool agrees = true;
+               replay_checker(const swap_trace& t, const disk_state& r) : trace(t), row(r) { }
+               void swapped(size_t i) {
+                 row.swap(i);
+                 if (++swaps % 5 == 0) {
+                   agrees = agrees && trace.state_after_swaps(swaps) == row;
+                 }
+               }
+               void pass_done(size_t pass, uint64_t) {
+                 agrees = agrees && trace.state_after_pass(pass) == row;
+               }
+             } checker(trace, row);
+             sort_left_to_right(row, checker);
+             TEST_TRUE("random access matches the run", checker.agrees);
+             TEST_EQUAL("state after no swaps", row, trace.state_after_swaps(0));
+
+             const std::string path = "disks_test_trace.bin";
+             {
+               trace_recorder to_file(row, path);
+               sort_lawnmower(row, to_file);
+             }
+             const auto from_file = read_swap_trace(path);
+             std::remove(path.c_str());
+             TEST_EQUAL("file trace after", output.after(), from_file.after());
+             TEST_EQUAL("file trace swaps", output.swap_count(), from_file.swap_count());
+
+             bool threw = false;
+             try {
+               swap_trace(std::vector<unsigned char>(10, 0));
+             } catch (const std::runtime_error&) {
+               threw = true;
+             }
+             TEST_TRUE("malformed trace throws", threw);
+
+             // a first swap at index -1
+             auto underflow = trace_recorder(disk_state(2)).bytes();
+             underflow.push_back(0x02);
+             threw = false;
+             try {
+               swap_trace trace(underflow);
+             } catch (const std::runtime_error&) {
+               threw = true;
+             }
+             TEST_TRUE("swap index underflow throws", threw);
+
+             TEST_EQUAL("short rows snapshot at the least interval", TRACE_SNAPSHOT_INTERVAL,
+                        swap_trace(recorder.bytes()).snapshot_interval());
+             const disk_state long_row(100000);
+             TEST_EQUAL("long rows snapshot less often",
+                        TRACE_SNAPSHOT_SWAPS_PER_WORD * long_row.word_count(),
+                        swap_trace(trace_recorder(long_row).bytes()).snapshot_interval());
+           });
+
   return rubric.run();
 }
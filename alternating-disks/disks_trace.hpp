@@ -0,0 +1,328 @@
+///////////////////////////////////////////////////////////////////////////////
+// disks_trace.hpp
+//
+// Recording and replaying the swaps of a disk sorting run.
+//
+// trace_recorder is an observer for sort_left_to_right and sort_lawnmower
+// that appends every swap to a byte stream, kept in memory or streamed to a
+// file. Trace format (all integers little-endian):
+//
+//    offset  size  field
+//         0     4  magic "DSKT"
+//         4     4  version, currently 1
+//         8     8  number of disks
+//        16        the packed words of the starting row, eight bytes each,
+//                  then one LEB128 varint token per event:
+//                    0      the end of a pass
+//                    v > 0  swap(i), where v - 1 is the difference from the
+//                           previous swap's i (0 at the start), zigzag-mapped
+//
+// The swaps of a pass move along the row, so almost every token is one
+// byte, and recording a swap is a subtraction, a shift and a push_back.
+//
+// swap_trace decodes a trace once, keeping a copy of the row every
+// snapshot_interval swaps. The row after any number of swaps is rebuilt from
+// the snapshot before it, replaying fewer than snapshot_interval swaps. By
+// default the interval grows with the row, at TRACE_SNAPSHOT_SWAPS_PER_WORD
+// swaps per packed word: a swap takes at least a byte of trace, so the
+// snapshots stay within an eighth of the trace's size however long the row.
+//
+// I/O failures and malformed traces are reported with std::runtime_error.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "disks.hpp"
+
+const char TRACE_MAGIC[4] = {'D', 'S', 'K', 'T'};
+const uint32_t TRACE_VERSION = 1;
+const size_t TRACE_HEADER_SIZE = 16;
+
+// Bytes a file recorder buffers before writing them out.
+const size_t TRACE_FLUSH_BYTES = 1 << 16;
+
+// Least number of swaps between two replay snapshots, and the swaps per
+// packed word of the row by which the default interval grows beyond it.
+const uint64_t TRACE_SNAPSHOT_INTERVAL = 1 << 12;
+const uint64_t TRACE_SNAPSHOT_SWAPS_PER_WORD = 64;
+
+namespace trace_detail {
+
+  using file_ptr = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+  inline void put_le(std::vector<unsigned char>& out, uint64_t x, size_t bytes) {
+    for (size_t b = 0; b < bytes; ++b, x >>= 8) {
+      out.push_back(static_cast<unsigned char>(x & 0xff));
+    }
+  }
+
+  inline uint64_t get_le(const unsigned char* in, size_t bytes) {
+    uint64_t x = 0;
+    for (size_t b = bytes; b-- > 0; ) {
+      x = (x << 8) | in[b];
+    }
+    return x;
+  }
+
+  inline void put_varint(std::vector<unsigned char>& out, uint64_t x) {
+    while (x >= 0x80) {
+      out.push_back(static_cast<unsigned char>(x | 0x80));
+      x >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(x));
+  }
+
+} // namespace trace_detail
+
+// Observer that records the swaps of one sort. Construct it with the row
+// being sorted, then pass it to the sort.
+class trace_recorder {
+private:
+  std::vector<unsigned char> _bytes;
+  trace_detail::file_ptr _file;
+  std::string _path;
+  size_t _disk_count;
+  size_t _previous = 0;
+
+  void write_header(const disk_state& before) {
+    for (auto c : TRACE_MAGIC) {
+      _bytes.push_back(static_cast<unsigned char>(c));
+    }
+    trace_detail::put_le(_bytes, TRACE_VERSION, 4);
+    trace_detail::put_le(_bytes, _disk_count, 8);
+    for (size_t w = 0; w < before.word_count(); ++w) {
+      trace_detail::put_le(_bytes, before.words()[w], 8);
+    }
+  }
+
+  void flush() {
+    if (_file) {
+      if (std::fwrite(_bytes.data(), 1, _bytes.size(), _file.get()) != _bytes.size()) {
+        throw std::runtime_error("disk trace: cannot write " + _path);
+      }
+      _bytes.clear();
+    }
+  }
+
+public:
+
+  // Record into memory; the trace is bytes() once the sort finishes.
+  explicit trace_recorder(const disk_state& before)
+    : _file(nullptr, &std::fclose), _disk_count(before.total_count()) {
+    write_header(before);
+  }
+
+  // Record into the file at path, written as the sort runs.
+  trace_recorder(const disk_state& before, const std::string& path)
+    : _file(std::fopen(path.c_str(), "wb"), &std::fclose), _path(path),
+      _disk_count(before.total_count()) {
+    if (!_file) {
+      throw std::runtime_error("disk trace: cannot open " + path);
+    }
+    write_header(before);
+    _bytes.reserve(TRACE_FLUSH_BYTES + 16);
+  }
+
+  void start(size_t disk_count) {
+    assert(disk_count == _disk_count);
+  }
+
+  void swapped(size_t left_index) {
+    const int64_t delta = int64_t(left_index) - int64_t(_previous);
+    _previous = left_index;
+    trace_detail::put_varint(_bytes, ((uint64_t(delta) << 1) ^ uint64_t(delta >> 63)) + 1);
+    if (_bytes.size() >= TRACE_FLUSH_BYTES) {
+      flush();
+    }
+  }
+
+  void pass_done(size_t /* pass */, uint64_t /* swaps */) {
+    _bytes.push_back(0);
+  }
+
+  void early_exit(size_t /* pass */) { }
+
+  void finish(uint64_t /* swap_count */) {
+    flush();
+    if (_file && std::fflush(_file.get()) != 0) {
+      throw std::runtime_error("disk trace: cannot write " + _path);
+    }
+  }
+
+  // The trace recorded in memory. A file recorder keeps no bytes once the
+  // sort has finished.
+  const std::vector<unsigned char>& bytes() const {
+    return _bytes;
+  }
+};
+
+// A decoded trace, with random access to the row after any swap.
+class swap_trace {
+private:
+  struct snapshot {
+    size_t offset;      // of the next token
+    size_t previous;    // i of the last swap
+    disk_state row;
+  };
+
+  std::vector<unsigned char> _bytes;
+  uint64_t _interval;
+  std::vector<snapshot> _snapshots;   // _snapshots[s] is after s * _interval swaps
+  std::vector<uint64_t> _pass_ends;   // swaps made by the end of each pass
+  uint64_t _swap_count = 0;
+
+  // Decode the token at offset, advancing offset.
+  uint64_t next_token(size_t& offset) const {
+    uint64_t token = 0;
+    for (unsigned shift = 0; ; shift += 7) {
+      if (offset == _bytes.size() || shift > 63) {
+        throw std::runtime_error("disk trace: malformed token");
+      }
+      const unsigned char byte = _bytes[offset++];
+      token |= uint64_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return token;
+      }
+    }
+  }
+
+  // Apply the swap of a nonzero token to row.
+  static void apply(disk_state& row, size_t& previous, uint64_t token) {
+    const uint64_t zigzag = token - 1;
+    const size_t index = previous + size_t(int64_t((zigzag >> 1) ^ (0 - (zigzag & 1))));
+    if (index >= row.total_count() - 1) {
+      throw std::runtime_error("disk trace: swap index out of range");
+    }
+    row.swap(index);
+    previous = index;
+  }
+
+  static disk_state header_row(const std::vector<unsigned char>& bytes) {
+    using trace_detail::get_le;
+    if (bytes.size() < TRACE_HEADER_SIZE || std::memcmp(bytes.data(), TRACE_MAGIC, 4) != 0) {
+      throw std::runtime_error("disk trace: not a disk trace");
+    }
+    if (get_le(bytes.data() + 4, 4) != TRACE_VERSION) {
+      throw std::runtime_error("disk trace: unsupported version");
+    }
+    const uint64_t count = get_le(bytes.data() + 8, 8);
+    const uint64_t word_count = count / disk_state::WORD_BITS + (count % disk_state::WORD_BITS != 0);
+    if (count == 0 || (bytes.size() - TRACE_HEADER_SIZE) / 8 < word_count) {
+      throw std::runtime_error("disk trace: malformed header");
+    }
+    std::vector<uint64_t> words(word_count);
+    for (size_t w = 0; w < word_count; ++w) {
+      words[w] = get_le(bytes.data() + TRACE_HEADER_SIZE + 8 * w, 8);
+    }
+    return disk_state(words.data(), count);
+  }
+
+public:
+
+  // Decode bytes, with a snapshot every snapshot_interval swaps; 0 picks
+  // the default for the row's length.
+  explicit swap_trace(std::vector<unsigned char> bytes, uint64_t snapshot_interval = 0)
+    : _bytes(std::move(bytes)), _interval(snapshot_interval) {
+
+    disk_state row = header_row(_bytes);
+    if (_interval == 0) {
+      _interval = std::max(TRACE_SNAPSHOT_INTERVAL,
+                           TRACE_SNAPSHOT_SWAPS_PER_WORD * row.word_count());
+    }
+    size_t offset = TRACE_HEADER_SIZE + 8 * row.word_count(), previous = 0;
+    _snapshots.push_back(snapshot{offset, previous, row});
+    while (offset < _bytes.size()) {
+      const uint64_t token = next_token(offset);
+      if (token == 0) {
+        _pass_ends.push_back(_swap_count);
+        continue;
+      }
+      apply(row, previous, token);
+      if (++_swap_count % _interval == 0) {
+        _snapshots.push_back(snapshot{offset, previous, row});
+      }
+    }
+  }
+
+  size_t disk_count() const {
+    return _snapshots.front().row.total_count();
+  }
+
+  uint64_t snapshot_interval() const {
+    return _interval;
+  }
+
+  uint64_t swap_count() const {
+    return _swap_count;
+  }
+
+  size_t pass_count() const {
+    return _pass_ends.size();
+  }
+
+  // Swaps made by the end of the given pass, counting passes from 1.
+  uint64_t swaps_through_pass(size_t pass) const {
+    assert(pass >= 1 && pass <= pass_count());
+    return _pass_ends[pass - 1];
+  }
+
+  const disk_state& before() const {
+    return _snapshots.front().row;
+  }
+
+  disk_state after() const {
+    return state_after_swaps(_swap_count);
+  }
+
+  // The row once the first swaps of the run are done.
+  disk_state state_after_swaps(uint64_t swaps) const {
+    assert(swaps <= _swap_count);
+    const snapshot& from = _snapshots[swaps / _interval];
+    disk_state row = from.row;
+    size_t offset = from.offset, previous = from.previous;
+    for (uint64_t done = swaps / _interval * _interval; done < swaps; ) {
+      const uint64_t token = next_token(offset);
+      if (token != 0) {
+        apply(row, previous, token);
+        ++done;
+      }
+    }
+    return row;
+  }
+
+  // The row at the end of the given pass, counting passes from 1.
+  disk_state state_after_pass(size_t pass) const {
+    return state_after_swaps(swaps_through_pass(pass));
+  }
+};
+
+// Decode the trace file at path.
+swap_trace read_swap_trace(const std::string& path, uint64_t snapshot_interval = 0) {
+  trace_detail::file_ptr in(std::fopen(path.c_str(), "rb"), &std::fclose);
+  if (!in) {
+    throw std::runtime_error("disk trace: cannot open " + path);
+  }
+  std::vector<unsigned char> bytes;
+  unsigned char buffer[1 << 16];
+  size_t got;
+  while ((got = std::fread(buffer, 1, sizeof(buffer), in.get())) > 0) {
+    bytes.insert(bytes.end(), buffer, buffer + got);
+  }
+  if (std::ferror(in.get())) {
+    throw std::runtime_error("disk trace: cannot read " + path);
+  }
+  return swap_trace(std::move(bytes), snapshot_interval);
+}
@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////
+// exhaustive_search.hpp
+//
+// A reusable framework for exhaustive optimization algorithms: enumerate
+// every candidate, keep the ones a verifier accepts, and return the best one
+// under an objective.
+//
+// A problem is described by function objects:
+//
+//    generator     enumerates candidates depth first (see subset_generator)
+//    verify(c)     true when candidate c is a solution
+//    objective(c)  the score of a solution c; larger is better
+//    bound(c)      optional: an upper bound on the score of every solution
+//                  among c and the candidates below it that could still be
+//                  returned (a subtree whose solutions all lose to ones
+//                  already visited may get any bound the best score
+//                  reaches). Called exactly once per visited candidate, so
+//                  it may keep state, such as dominance records.
+//
+// The search visits candidates in the generator's order, keeps the first
+// solution of the best score, and skips c and the candidates below it
+// whenever bound(c) cannot beat the best score found so far. All of these
+// are template parameters, so each problem compiles to its own loop with
+// the calls inlined, and no virtual calls are involved. The LIS searches of
+// subsequence.hpp and lis_parallel.hpp are instances.
+//
+// parallel_exhaustive_search runs the subtrees below the first level of the
+// enumeration on a work_stealing_pool, with the best score shared through an
+// atomic so every worker prunes with the global bound. It returns the same
+// solution as the serial search.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "../DP-LIS/work_stealing_pool.hpp"
+
+namespace exhaustive {
+
+// Enumerates the nonempty subsets of {0, ..., n - 1} as increasing index
+// lists, in the depth-first order of longest_increasing_powerset: each list
+// is followed by its extensions, then by its next sibling. The enumeration
+// can be restricted to the subsets whose first index is in
+// [first_begin, first_end).
+class subset_generator {
+private:
+  size_t _n, _first_begin, _first_end;
+  std::vector<size_t> _indices;
+
+public:
+  using candidate_type = std::vector<size_t>;
+
+  explicit subset_generator(size_t n)
+    : subset_generator(n, 0, n) { }
+
+  subset_generator(size_t n, size_t first_begin, size_t first_end)
+    : _n(n), _first_begin(first_begin), _first_end(first_end) {
+    assert(first_begin <= first_end && first_end <= n);
+  }
+
+  // Move to the next candidate; when descend is false, the candidates below
+  // the current one are skipped. Returns false when there are no more.
+  bool next(bool descend = true) {
+    if (_indices.empty()) {
+      if (_first_begin == _first_end) {
+        return false;
+      }
+      _indices.push_back(_first_begin);
+      _first_begin = _first_end;   // the first level is entered only once
+      return true;
+    }
+    if (descend && _indices.back() + 1 < _n) {
+      _indices.push_back(_indices.back() + 1);
+      return true;
+    }
+    while (!_indices.empty()) {
+      const size_t limit = _indices.size() == 1 ? _first_end : _n;
+      if (++_indices.back() < limit) {
+        return true;
+      }
+      _indices.pop_back();
+    }
+    return false;
+  }
+
+  const candidate_type& candidate() const {
+    return _indices;
+  }
+};
+
+// The bound of problems without one: nothing is ever pruned.
+struct no_bound { };
+
+template <typename Candidate, typename Score>
+struct exhaustive_result {
+  bool found = false;
+  Candidate best;
+  Score score = Score();
+};
+
+namespace exhaustive_search_detail {
+
+  // True when the candidates from c down are worth visiting: a solution
+  // among them may beat the best of this search, and tie with the score
+  // shared between threads when shared is not null. Ties with the shared
+  // score are kept, since a tie from an earlier subtree is decided by the
+  // caller. bound is called exactly once per candidate.
+  template <typename Candidate, typename Result, typename Score>
+  bool within_bound(no_bound&, const Candidate&, const Result&, const std::atomic<Score>*) {
+    return true;
+  }
+
+  template <typename Bound, typename Candidate, typename Result, typename Score>
+  bool within_bound(Bound& bound, const Candidate& c, const Result& result,
+                    const std::atomic<Score>* shared) {
+    const Score limit = bound(c);
+    return !(result.found && !(result.score < limit)) &&
+           !(shared && limit < shared->load(std::memory_order_relaxed));
+  }
+
+  // Raise shared to score, if score is larger.
+  template <typename Score>
+  void publish(std::atomic<Score>& shared, const Score& score) {
+    Score seen = shared.load(std::memory_order_relaxed);
+    while (seen < score &&
+           !shared.compare_exchange_weak(seen, score, std::memory_order_relaxed)) { }
+  }
+
+  // The serial search, also pruning against a score shared between threads
+  // when shared is not null.
+  template <typename Generator, typename Verifier, typename Objective,
+            typename Bound, typename Score>
+  exhaustive_result<typename Generator::candidate_type, Score>
+  search(Generator& generator, Verifier& verify, Objective& objective,
+         Bound& bound, std::atomic<Score>* shared) {
+
+    exhaustive_result<typename Generator::candidate_type, Score> result;
+    bool descend = true;
+    while (generator.next(descend)) {
+      const auto& c = generator.candidate();
+      descend = within_bound(bound, c, result, shared);
+      if (!descend) {
+        continue;
+      }
+      if (verify(c)) {
+        const Score score = objective(c);
+        if (!result.found || result.score < score) {
+          result.found = true;
+          result.best = c;
+          result.score = score;
+          if (shared) {
+            publish(*shared, score);
+          }
+        }
+      }
+    }
+    return result;
+  }
+
+} // namespace exhaustive_search_detail
+
+template <typename Generator, typename Verifier, typename Objective,
+          typename Bound = no_bound>
+auto exhaustive_search(Generator generator, Verifier verify, Objective objective,
+                       Bound bound = Bound()) {
+  using score_type = decltype(objective(generator.candidate()));
+  return exhaustive_search_detail::search(generator, verify, objective, bound,
+                                          static_cast<std::atomic<score_type>*>(nullptr));
+}
+
+// Run the search on pool. The enumeration has roots subtrees below its
+// first level, and make_generator(first_begin, first_end) returns the
+// generator restricted to the subtrees [first_begin, first_end), as
+// subset_generator does. floor is a score no solution falls below. Score
+// must be usable in a std::atomic. Every chunk of subtrees gets its own copy
+// of verify, objective and bound, so a bound that keeps state shares it
+// between threads only through pointers.
+template <typename GeneratorFactory, typename Verifier, typename Objective,
+          typename Bound, typename Score>
+auto parallel_exhaustive_search(work_stealing_pool& pool, size_t roots,
+                                GeneratorFactory make_generator,
+                                Verifier verify, Objective objective,
+                                Bound bound, Score floor) {
+  using generator_type = decltype(make_generator(size_t(0), size_t(0)));
+  using result_type = exhaustive_result<typename generator_type::candidate_type, Score>;
+
+  // found[f] is the result of the chunk starting at subtree f
+  std::vector<result_type> found(roots);
+  std::atomic<Score> shared(floor);
+
+  pool.parallel_for(roots, 1, [&](unsigned, size_t begin, size_t end) {
+    auto generator = make_generator(begin, end);
+    Verifier chunk_verify = verify;
+    Objective chunk_objective = objective;
+    Bound chunk_bound = bound;
+    found[begin] = exhaustive_search_detail::search(generator, chunk_verify, chunk_objective,
+                                                    chunk_bound, &shared);
+  });
+
+  result_type best;
+  for (auto& result : found) {
+    if (result.found && (!best.found || best.score < result.score)) {
+      best = std::move(result);
+    }
+  }
+  return best;
+}
+
+} // namespace exhaustive
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_anytime.hpp
+//
+// Anytime exhaustive search for the longest increasing subsequence, for
+// long runs on shared machines.
+//
+// longest_increasing_anytime runs the Gray-code powerset search in slices
+// of ANYTIME_SLICE subsets. Between slices it checks a search_controller:
+// the run stops when the time or node budget is spent or when cancel() has
+// been called (from any thread), and progress is reported to a callback at
+// a fixed interval. A slice takes well under a millisecond, which bounds
+// how late a stop takes effect. A stopped run returns the best subsequence
+// among the subsets visited so far. Every run clears the cancellation when
+// it returns, so a controller can be reused for the next run.
+//
+// With a checkpoint_path set, the search state is also saved there
+// periodically and whenever the run stops; resume_longest_increasing picks
+// the search up from that file, and its result matches an uninterrupted
+// run exactly.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "lis_checkpoint.hpp"
+#include "subsequence.hpp"
+#include "timer.hpp"
+
+namespace exhaustive {
+
+// Number of subsets visited between two checks of the controller.
+const uint64_t ANYTIME_SLICE = 1 << 16;
+
+enum search_status {
+  SEARCH_COMPLETE,
+  SEARCH_TIME_BUDGET,
+  SEARCH_NODE_BUDGET,
+  SEARCH_CANCELLED
+};
+
+struct search_progress {
+  double covered = 0;        // fraction of the subset space visited
+  uint64_t nodes = 0;        // subsets visited by this run
+  size_t best_length = 0;    // length of the best subsequence so far
+  double elapsed = 0;        // seconds since this run started
+};
+
+struct anytime_result;
+class search_controller;
+
+anytime_result longest_increasing_anytime(const sequence& A, search_controller& control,
+                                          gray_code_state& state);
+
+class search_controller {
+private:
+  std::atomic<bool> _cancelled{false};
+
+  friend anytime_result longest_increasing_anytime(const sequence& A,
+                                                   search_controller& control,
+                                                   gray_code_state& state);
+
+public:
+  // Limits of one run; zero means no limit.
+  double time_budget = 0;    // seconds
+  uint64_t node_budget = 0;  // subsets
+
+  // Called about every progress_interval seconds, and once at the end.
+  std::function<void(const search_progress&)> on_progress;
+  double progress_interval = 1;
+
+  // When set, the search state is saved to this file about every
+  // checkpoint_interval seconds, and when the run stops.
+  std::string checkpoint_path;
+  double checkpoint_interval = 60;
+
+  // Ask the running search, or the next one to start, to stop at its next
+  // check.
+  void cancel() {
+    _cancelled.store(true, std::memory_order_relaxed);
+  }
+
+  bool cancelled() const {
+    return _cancelled.load(std::memory_order_relaxed);
+  }
+};
+
+struct anytime_result {
+  sequence best;
+  search_status status;
+  search_progress progress;
+
+  bool complete() const {
+    return status == SEARCH_COMPLETE;
+  }
+};
+
+// Continue the search on A from state, which is updated as it goes.
+anytime_result longest_increasing_anytime(const sequence& A, search_controller& control,
+                                          gray_code_state& state) {
+  const uint64_t total = gray_code_steps(A.size());
+
+  Timer timer;
+  double last_report = 0, last_checkpoint = 0;
+  anytime_result result;
+  result.status = SEARCH_COMPLETE;
+
+  auto update_progress = [&]() {
+    result.progress.covered = total == 0 ? 1.0 : double(state.step - 1) / double(total);
+    result.progress.best_length = state.best_size;
+    result.progress.elapsed = timer.elapsed();
+  };
+
+  while (!gray_code_done(A, state)) {
+    if (control.cancelled()) {
+      result.status = SEARCH_CANCELLED;
+      break;
+    }
+    uint64_t slice = ANYTIME_SLICE;
+    if (control.node_budget != 0) {
+      if (result.progress.nodes >= control.node_budget) {
+        result.status = SEARCH_NODE_BUDGET;
+        break;
+      }
+      slice = std::min(slice, control.node_budget - result.progress.nodes);
+    }
+
+    const uint64_t before = state.step;
+    gray_code_advance(A, state, slice);
+    result.progress.nodes += state.step - before;
+
+    update_progress();
+    if (control.time_budget != 0 && result.progress.elapsed >= control.time_budget &&
+        !gray_code_done(A, state)) {
+      result.status = SEARCH_TIME_BUDGET;
+      break;
+    }
+    if (control.on_progress &&
+        result.progress.elapsed - last_report >= control.progress_interval) {
+      last_report = result.progress.elapsed;
+      control.on_progress(result.progress);
+    }
+    if (!control.checkpoint_path.empty() &&
+        result.progress.elapsed - last_checkpoint >= control.checkpoint_interval) {
+      last_checkpoint = result.progress.elapsed;
+      save_checkpoint(control.checkpoint_path, A, state);
+    }
+  }
+
+  update_progress();
+  if (!control.checkpoint_path.empty()) {
+    save_checkpoint(control.checkpoint_path, A, state);
+  }
+  if (control.on_progress) {
+    control.on_progress(result.progress);
+  }
+  result.best = mask_to_sequence(A, state.best_mask);
+  control._cancelled.store(false, std::memory_order_relaxed);
+  return result;
+}
+
+anytime_result longest_increasing_anytime(const sequence& A, search_controller& control) {
+  gray_code_state state;
+  return longest_increasing_anytime(A, control, state);
+}
+
+// Continue the search on A from the checkpoint at control.checkpoint_path,
+// or start it when there is no checkpoint yet.
+anytime_result resume_longest_increasing(const sequence& A, search_controller& control) {
+  assert(!control.checkpoint_path.empty());
+  gray_code_state state;
+  if (checkpoint_exists(control.checkpoint_path)) {
+    state = load_checkpoint(control.checkpoint_path, A);
+  }
+  return longest_increasing_anytime(A, control, state);
+}
+
+} // namespace exhaustive
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_checkpoint.hpp
+//
+// Checkpoint files for the Gray-code exhaustive search, so a long run can be
+// resumed after a crash or preemption.
+//
+// The whole search state is a gray_code_state of six integers, so a
+// checkpoint is a fixed 72-byte file (all integers little-endian):
+//
+//    offset  size  field
+//         0     4  magic "LISC"
+//         4     2  version, currently 1
+//         6     2  zero
+//         8     8  number of elements of the input
+//        16     8  FNV-1a hash of the input elements
+//        24    48  step, mask, best_mask, size, best_size, violations
+//
+// The input size and hash guard against resuming with a different input.
+// A checkpoint is written to a temporary file, flushed and synced to the
+// disk, then renamed over the old one (MoveFileEx on Windows, where rename
+// will not replace an existing file), so an interrupted write or a power
+// failure leaves either the previous checkpoint or the new one.
+// I/O failures and bad checkpoints are reported with std::runtime_error.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "subsequence.hpp"
+
+namespace exhaustive {
+
+const char CHECKPOINT_MAGIC[4] = {'L', 'I', 'S', 'C'};
+const uint16_t CHECKPOINT_VERSION = 1;
+const size_t CHECKPOINT_SIZE = 72;
+
+namespace checkpoint_detail {
+
+  // Flush out's buffer and have the system write the file to the disk.
+  inline bool sync_file(std::FILE* out) {
+    if (std::fflush(out) != 0) {
+      return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(out)) == 0;
+#else
+    return fsync(fileno(out)) == 0;
+#endif
+  }
+
+  // Rename from to to, replacing to when it exists.
+  inline bool replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+  }
+
+} // namespace checkpoint_detail
+
+// FNV-1a hash of the elements of A.
+uint64_t sequence_hash(const sequence& A) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (auto x : A) {
+    uint32_t bits = static_cast<uint32_t>(x);
+    for (int b = 0; b < 4; ++b, bits >>= 8) {
+      hash = (hash ^ (bits & 0xff)) * 0x100000001b3ULL;
+    }
+  }
+  return hash;
+}
+
+// Write the state of the search on A to path.
+void save_checkpoint(const std::string& path, const sequence& A,
+                     const gray_code_state& state) {
+  unsigned char bytes[CHECKPOINT_SIZE] = {};
+  auto put = [&](size_t offset, uint64_t x, size_t size) {
+    for (size_t b = 0; b < size; ++b, x >>= 8) {
+      bytes[offset + b] = static_cast<unsigned char>(x & 0xff);
+    }
+  };
+  std::memcpy(bytes, CHECKPOINT_MAGIC, 4);
+  put(4, CHECKPOINT_VERSION, 2);
+  put(8, A.size(), 8);
+  put(16, sequence_hash(A), 8);
+  put(24, state.step, 8);
+  put(32, state.mask, 8);
+  put(40, state.best_mask, 8);
+  put(48, state.size, 8);
+  put(56, state.best_size, 8);
+  put(64, state.violations, 8);
+
+  const std::string temporary = path + ".tmp";
+  std::FILE* out = std::fopen(temporary.c_str(), "wb");
+  bool written = out && std::fwrite(bytes, 1, CHECKPOINT_SIZE, out) == CHECKPOINT_SIZE
+                 && checkpoint_detail::sync_file(out);
+  if (out) {
+    written = std::fclose(out) == 0 && written;
+  }
+  if (!written || !checkpoint_detail::replace_file(temporary, path)) {
+    std::remove(temporary.c_str());
+    throw std::runtime_error("checkpoint: cannot write " + path);
+  }
+}
+
+// True when path names an existing file.
+bool checkpoint_exists(const std::string& path) {
+  std::FILE* in = std::fopen(path.c_str(), "rb");
+  if (in) {
+    std::fclose(in);
+  }
+  return in != nullptr;
+}
+
+// Read the state of the search on A from path.
+gray_code_state load_checkpoint(const std::string& path, const sequence& A) {
+  unsigned char bytes[CHECKPOINT_SIZE + 1];
+  std::FILE* in = std::fopen(path.c_str(), "rb");
+  if (!in) {
+    throw std::runtime_error("checkpoint: cannot open " + path);
+  }
+  const size_t got = std::fread(bytes, 1, sizeof(bytes), in);
+  std::fclose(in);
+  if (got != CHECKPOINT_SIZE || std::memcmp(bytes, CHECKPOINT_MAGIC, 4) != 0) {
+    throw std::runtime_error("checkpoint: not a checkpoint file " + path);
+  }
+
+  auto field = [&](size_t offset, size_t size) {
+    uint64_t x = 0;
+    for (size_t b = size; b-- > 0; ) {
+      x = (x << 8) | bytes[offset + b];
+    }
+    return x;
+  };
+  if (field(4, 2) != CHECKPOINT_VERSION) {
+    throw std::runtime_error("checkpoint: unsupported version");
+  }
+  if (field(8, 8) != A.size() || field(16, 8) != sequence_hash(A)) {
+    throw std::runtime_error("checkpoint: written for a different input");
+  }
+
+  gray_code_state state;
+  state.step = field(24, 8);
+  state.mask = field(32, 8);
+  state.best_mask = field(40, 8);
+  state.size = field(48, 8);
+  state.best_size = field(56, 8);
+  state.violations = field(64, 8);
+  // after step - 1 steps the mask is the Gray code of step - 1
+  const uint64_t done = state.step - 1;
+  if (state.step == 0 || done > gray_code_steps(A.size()) ||
+      state.mask != (done ^ (done >> 1))) {
+    throw std::runtime_error("checkpoint: corrupt search state");
+  }
+  return state;
+}
+
+} // namespace exhaustive
@@ -0,0 +1,43 @@
+///////////////////////////////////////////////////////////////////////////////
+// lis_parallel.hpp
+//
+// Multithreaded exhaustive search for the longest increasing subsequence.
+//
+// The branch and bound search of subsequence.hpp run with
+// parallel_exhaustive_search: the subset space splits into independent
+// subtrees by the first element of the subset, which are the work items of
+// a work_stealing_pool loop. The workers share their best length through
+// the framework's atomic, so every worker prunes with the global bound, and
+// share the dominance records, so no prefix is expanded twice across
+// workers. The result is the same subsequence the serial searches return:
+// the longest one from the earliest subtree.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "exhaustive_search.hpp"
+#include "subsequence.hpp"
+#include "../DP-LIS/work_stealing_pool.hpp"
+
+namespace exhaustive {
+
+sequence longest_increasing_parallel(const sequence& A, work_stealing_pool& pool) {
+  const size_t n = A.size();
+  assert(n < UINT32_MAX);
+  prefix_records explored(n);
+  auto result = parallel_exhaustive_search(pool, n,
+                                           [n](size_t begin, size_t end) {
+                                             return subset_generator(n, begin, end);
+                                           },
+                                           increasing_subset{&A}, subset_size(),
+                                           increasing_subset_bound{&A, &explored},
+                                           size_t(0));
+  return select_elements(A, result.best);
+}
+
+} // namespace exhaustive
@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// powerset_benchmark.cpp
+//
+// Compares the Gray-code mask enumeration with longest_increasing_powerset
+// on the inputs of subsequence_timing, for n = 20 to 34.
+//
+// usage: powerset_benchmark [max_n [max_powerset_n]]
+//
+// The powerset search needs hours at n = 34, so by default it only runs up
+// to n = 24; pass a larger max_powerset_n to time it further.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include "timer.hpp"
+
+#include "subsequence.hpp"
+
+using namespace exhaustive;
+
+int main(int argc, char* argv[]) {
+
+  const size_t max_n = argc > 1 ? std::atoi(argv[1]) : 34;
+  const size_t max_powerset_n = argc > 2 ? std::atoi(argv[2]) : 24;
+
+  Timer timer;
+
+  std::cout << "n\tlength\tgray code\tpowerset (seconds)" << std::endl;
+  for (size_t n = 20; n <= max_n; ++n) {
+    auto input = random_sequence(n, 0, 1000);
+
+    timer.reset();
+    auto gray_output = longest_increasing_gray_code(input);
+    std::cout << n << "\t" << gray_output.size() << "\t" << timer.elapsed();
+
+    if (n <= max_powerset_n) {
+      timer.reset();
+      auto powerset_output = longest_increasing_powerset(input);
+      std::cout << "\t" << timer.elapsed();
+      assert(powerset_output == gray_output);
+    }
+    std::cout << std::endl;
+  }
+
+  return 0;
+}
@@ -4,17 +4,30 @@
 // An exhaustive optimization algorithm for solving 
 // the longest increasing subsequence problem.
 //
+// The powerset and branch and bound searches are instances of the
+// exhaustive_search framework (exhaustive_search.hpp); the Gray-code search
+// is a separate mask enumeration.
+//
+// The headers of this project declare everything in namespace exhaustive,
+// so other projects can include them next to their own subsequence.hpp.
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <random>
 #include <string>
 #include <sstream>
 #include <vector>
 
+#include "exhaustive_search.hpp"
+
+namespace exhaustive {
+
 using sequence = std::vector<int>;
 
 // Convert a sequence into a human-readable string useful for pretty-printing
@@ -63,38 +76,258 @@ bool is_increasing(const sequence& A) {
   return true;
 }
 
+// The longest increasing subsequence problem as an instance of the
+// exhaustive_search framework: the candidates are the subsets of indices of
+// A, a candidate is a solution when its elements are increasing, and its
+// score is its size. The searches below differ only in the bound.
+
+// verifier: the selected elements are increasing
+struct increasing_subset {
+  const sequence* A;
+
+  bool operator()(const std::vector<size_t>& indices) const {
+    for (size_t i = 1; i < indices.size(); ++i) {
+      if ((*A)[indices[i]] <= (*A)[indices[i - 1]]) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+// objective: the number of selected elements
+struct subset_size {
+  size_t operator()(const std::vector<size_t>& indices) const {
+    return indices.size();
+  }
+};
+
+// The elements of A at the given indices.
+sequence select_elements(const sequence& A, const std::vector<size_t>& indices) {
+  sequence result;
+  result.reserve(indices.size());
+  for (auto i : indices) {
+    result.push_back(A[i]);
+  }
+  return result;
+}
+
+// Visits all 2^n - 1 nonempty subsets, and returns the first longest
+// increasing one in enumeration order.
 sequence longest_increasing_powerset(const sequence& A) {
-  const size_t n = A.size();
-  sequence best;  // initally sequence{0}
-  std::vector<size_t> stack(n+1, 0);
-  size_t k = 0;
-  while (true) {  // runs 2^n times generating each member of the powerset
-
-    if (stack[k] < n) {
-      stack[k+1] = stack[k] + 1;
-      ++k;
-    } else {
-      stack[k-1]++;
-      k--;
+  auto result = exhaustive_search(subset_generator(A.size()),
+                                  increasing_subset{&A}, subset_size());
+  return select_elements(A, result.best);
+}
+
+// Bound of the branch and bound search. It walks the same subsets in the
+// same order as longest_increasing_powerset, but cuts a subset, with
+// everything below it, when
+//
+//  - its last two elements are out of order: increasingness is hereditary,
+//    so no extension is increasing either (the earlier pairs were checked
+//    when the shorter subsets were visited),
+//  - its size plus the number of elements after its last index cannot
+//    exceed the best length found so far, or
+//  - an earlier subset of at least the same size already ended at the same
+//    element. Every completion of the current subset also completes the
+//    earlier one, so the earlier branch has already seen everything this
+//    one could reach.
+//
+// Each cut only drops subsets that cannot be strictly longer than one
+// already visited, so the result is the same subsequence the powerset
+// search returns. Each element is expanded at most once per size, so the
+// search takes O(n^3) time in the worst case instead of visiting all 2^n
+// subsets.
+//
+// The dominance cut keeps, for every element, a record of the best subset
+// ending there so far: (size << 32) | (UINT32_MAX - first index), so that a
+// larger record means a longer subset, or an equally long one from an
+// earlier subtree, whose completions win any tie. The records are atomic so
+// that parallel searches can share them. A dominated subset gets the bound
+// 0, which the best length (at least 1 after the first subset) reaches.
+using prefix_records = std::vector<std::atomic<uint64_t>>;
+
+// Claim the record of element j for a subset with the given key. Returns
+// false when an equal or better subset already holds it.
+bool claim_prefix(prefix_records& explored, size_t j, uint64_t key) {
+  uint64_t seen = explored[j].load(std::memory_order_relaxed);
+  do {
+    if (seen >= key) {
+      return false;
     }
+  } while (!explored[j].compare_exchange_weak(seen, key, std::memory_order_relaxed));
+  return true;
+}
+
+struct increasing_subset_bound {
+  const sequence* A;
+  prefix_records* explored;
 
-    if (k == 0) {   // will only reach this when the algorithm is finished
-      break;
+  size_t operator()(const std::vector<size_t>& indices) const {
+    const size_t k = indices.size(), last = indices.back();
+    if (k >= 2 && (*A)[last] <= (*A)[indices[k - 2]]) {
+      return 0;
     }
+    if (!claim_prefix(*explored, last, (uint64_t(k) << 32) | (UINT32_MAX - indices[0]))) {
+      return 0;
+    }
+    return k + (A->size() - 1 - last);
+  }
+};
+
+sequence longest_increasing_branch_and_bound(const sequence& A) {
+  assert(A.size() < UINT32_MAX);
+  prefix_records explored(A.size());
+  auto result = exhaustive_search(subset_generator(A.size()),
+                                  increasing_subset{&A}, subset_size(),
+                                  increasing_subset_bound{&A, &explored});
+  return select_elements(A, result.best);
+}
+
+// Index of the lowest and highest set bit of a nonzero mask.
+inline unsigned lowest_bit_index(uint64_t mask) {
+  assert(mask != 0);
+#ifdef __GNUC__
+  return __builtin_ctzll(mask);
+#else
+  unsigned i = 0;
+  for (; !(mask & 1); mask >>= 1) {
+    ++i;
+  }
+  return i;
+#endif
+}
+
+inline unsigned highest_bit_index(uint64_t mask) {
+  assert(mask != 0);
+#ifdef __GNUC__
+  return 63 - __builtin_clzll(mask);
+#else
+  unsigned i = 0;
+  while (mask >>= 1) {
+    ++i;
+  }
+  return i;
+#endif
+}
+
+inline unsigned popcount_mask(uint64_t mask) {
+#ifdef __GNUC__
+  return __builtin_popcountll(mask);
+#else
+  unsigned count = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+// Powerset search over 64-bit masks, for n < 64. Bit i of a mask selects
+// A[i], and the masks are visited in Gray-code order, so each step adds or
+// removes a single element. The search keeps the number of neighbouring
+// selected pairs that are out of order: flipping element b only changes the
+// pairs between b and its selected neighbours, found with two bit scans, so
+// a subset is checked in O(1) without building it, and nothing is allocated
+// until the result is extracted from the best mask.
+//
+// Among subsets of the best length the one with the smallest first
+// differing index wins, which is the subset longest_increasing_powerset
+// returns.
+//
+// The whole state of the search is a gray_code_state, so it can be run in
+// slices with gray_code_advance.
+struct gray_code_state {
+  uint64_t step = 1;   // the next step flips the lowest set bit of step
+  uint64_t mask = 0, best_mask = 0;
+  uint64_t size = 0, best_size = 0, violations = 0;
+};
+
+// Number of steps of the Gray-code search over n elements.
+inline uint64_t gray_code_steps(size_t n) {
+  assert(n < 64);
+  return (uint64_t(1) << n) - 1;
+}
+
+inline bool gray_code_done(const sequence& A, const gray_code_state& state) {
+  return state.step > gray_code_steps(A.size());
+}
+
+// Run up to steps more steps of the Gray-code search on A.
+void gray_code_advance(const sequence& A, gray_code_state& state, uint64_t steps) {
+  const uint64_t last = gray_code_steps(A.size());
 
-    sequence candidate;
-    for (size_t i = 1; i <= k; ++i) {   // each element of the current set is pasted into the candidate
-      candidate.push_back(A[stack[i]-1]);
+  // true when A[j] cannot follow A[i]
+  auto out_of_order = [&](unsigned i, unsigned j) -> uint64_t {
+    return A[j] <= A[i];
+  };
+
+  uint64_t mask = state.mask, best_mask = state.best_mask;
+  uint64_t size = state.size, best_size = state.best_size, violations = state.violations;
+  uint64_t k = state.step;
+  const uint64_t end = last - k < steps ? last + 1 : k + steps;
+
+  for (; k < end; ++k) {
+    const unsigned b = lowest_bit_index(k);
+    const uint64_t bit = uint64_t(1) << b;
+    const uint64_t below = mask & (bit - 1), above = mask & (~uint64_t(1) << b);
+    const bool has_below = below != 0, has_above = above != 0;
+    const unsigned p = has_below ? highest_bit_index(below) : 0;
+    const unsigned s = has_above ? lowest_bit_index(above) : 0;
+
+    // pairs (p, b) and (b, s) replace (p, s), or the other way around
+    uint64_t with_b = 0, without_b = 0;
+    if (has_below) {
+      with_b += out_of_order(p, b);
+    }
+    if (has_above) {
+      with_b += out_of_order(b, s);
+    }
+    if (has_below && has_above) {
+      without_b = out_of_order(p, s);
     }
 
-    if (is_increasing(candidate))   // verifier
-    {
-      if (best == sequence{0} || candidate.size() > best.size())  // optimization comparison
-      {
-        best = candidate;   // replace with the current longest subsequence
-      }
+    if (mask & bit) {
+      violations = violations - with_b + without_b;
+      --size;
+    } else {
+      violations = violations - without_b + with_b;
+      ++size;
     }
+    mask ^= bit;
+
+    // on a tie, keep the subset holding the lowest index where they differ
+    const uint64_t differ = mask ^ best_mask;
+    if (violations == 0 &&
+        (size > best_size || (size == best_size && (mask & differ & (0 - differ))))) {
+      best_mask = mask;
+      best_size = size;
     }
+  }
+
+  state.step = k;
+  state.mask = mask;
+  state.best_mask = best_mask;
+  state.size = size;
+  state.best_size = best_size;
+  state.violations = violations;
+}
 
-  return best;  // all possible subsequences within the sequence have been analyzed
+// The elements of A selected by mask.
+sequence mask_to_sequence(const sequence& A, uint64_t mask) {
+  sequence result;
+  result.reserve(popcount_mask(mask));
+  for (; mask != 0; mask &= mask - 1) {
+    result.push_back(A[lowest_bit_index(mask)]);
+  }
+  return result;
 }
+
+sequence longest_increasing_gray_code(const sequence& A) {
+  gray_code_state state;
+  gray_code_advance(A, state, gray_code_steps(A.size()));
+  return mask_to_sequence(A, state.best_mask);
+}
+
+} // namespace exhaustive
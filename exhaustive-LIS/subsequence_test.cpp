@@ -6,11 +6,19 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
 
 #include "rubrictest.hpp"
 
+#include "exhaustive_search.hpp"
+#include "lis_anytime.hpp"
+#include "lis_parallel.hpp"
 #include "subsequence.hpp"
 
+using namespace exhaustive;
+
 int main() {
 
   Rubric rubric;
@@ -71,6 +79,203 @@ int main() {
                      [&]() {
                          TEST_EQUAL("input8", solution8, longest_increasing_powerset(input8));
                      });
+
+    rubric.criterion("branch and bound", 1,
+                     [&]() {
+                         TEST_EQUAL("input1", solution1, longest_increasing_branch_and_bound(input1));
+                         TEST_EQUAL("input2", solution2, longest_increasing_branch_and_bound(input2));
+                         TEST_EQUAL("input3", solution3, longest_increasing_branch_and_bound(input3));
+                         TEST_EQUAL("input4", solution4, longest_increasing_branch_and_bound(input4));
+                         TEST_EQUAL("input5", solution5, longest_increasing_branch_and_bound(input5));
+                         TEST_EQUAL("input6", solution6, longest_increasing_branch_and_bound(input6));
+                         TEST_EQUAL("input7", solution7, longest_increasing_branch_and_bound(input7));
+                         TEST_EQUAL("input8", solution8, longest_increasing_branch_and_bound(input8));
+                         TEST_EQUAL("empty", sequence{}, longest_increasing_branch_and_bound(sequence{}));
+
+                         // same subsequence as the powerset search, ties included
+                         for (unsigned seed = 0; seed < 50; ++seed) {
+                           auto input = random_sequence(12, seed, seed % 2 ? 1000 : 6);
+                           TEST_EQUAL("random", longest_increasing_powerset(input),
+                                      longest_increasing_branch_and_bound(input));
+                         }
+
+                         // far beyond the reach of the powerset search
+                         sequence sorted;
+                         for (int i = 0; i < 400; ++i) {
+                           sorted.push_back(i);
+                         }
+                         TEST_EQUAL("sorted", sorted, longest_increasing_branch_and_bound(sorted));
+                         auto large = longest_increasing_branch_and_bound(random_sequence(400, 1, 100000));
+                         TEST_TRUE("large increasing", is_increasing(large));
+                         TEST_EQUAL("large length", size_t(35), large.size());
+                     });
+
+    rubric.criterion("parallel", 1,
+                     [&]() {
+                         work_stealing_pool serial(1), pool(4);
+                         TEST_EQUAL("input2", solution2, longest_increasing_parallel(input2, pool));
+                         TEST_EQUAL("input7", solution7, longest_increasing_parallel(input7, pool));
+                         TEST_EQUAL("input8", solution8, longest_increasing_parallel(input8, pool));
+                         TEST_EQUAL("empty", sequence{}, longest_increasing_parallel(sequence{}, pool));
+
+                         // same subsequence as the serial search, ties included
+                         for (unsigned seed = 0; seed < 50; ++seed) {
+                           auto input = random_sequence(40 + seed, seed, seed % 2 ? 1000 : 8);
+                           auto expected = longest_increasing_branch_and_bound(input);
+                           TEST_EQUAL("one worker", expected, longest_increasing_parallel(input, serial));
+                           TEST_EQUAL("four workers", expected, longest_increasing_parallel(input, pool));
+                         }
+                     });
+
+    rubric.criterion("gray code", 1,
+                     [&]() {
+                         TEST_EQUAL("input1", solution1, longest_increasing_gray_code(input1));
+                         TEST_EQUAL("input2", solution2, longest_increasing_gray_code(input2));
+                         TEST_EQUAL("input3", solution3, longest_increasing_gray_code(input3));
+                         TEST_EQUAL("input4", solution4, longest_increasing_gray_code(input4));
+                         TEST_EQUAL("input5", solution5, longest_increasing_gray_code(input5));
+                         TEST_EQUAL("input6", solution6, longest_increasing_gray_code(input6));
+                         TEST_EQUAL("input7", solution7, longest_increasing_gray_code(input7));
+                         TEST_EQUAL("input8", solution8, longest_increasing_gray_code(input8));
+                         TEST_EQUAL("empty", sequence{}, longest_increasing_gray_code(sequence{}));
+
+                         // same subsequence as the powerset search, ties included
+                         for (unsigned seed = 0; seed < 50; ++seed) {
+                           auto input = random_sequence(12, seed, seed % 2 ? 1000 : 6);
+                           TEST_EQUAL("random", longest_increasing_powerset(input),
+                                      longest_increasing_gray_code(input));
+                         }
+                     });
+
+    rubric.criterion("anytime search", 1,
+                     [&]() {
+                         const auto input = random_sequence(24, 3, 1000);
+                         const auto complete = longest_increasing_gray_code(input);
+
+                         search_controller unlimited;
+                         auto full = longest_increasing_anytime(input, unlimited);
+                         TEST_TRUE("complete", full.complete());
+                         TEST_EQUAL("complete result", complete, full.best);
+                         TEST_EQUAL("all covered", 1.0, full.progress.covered);
+
+                         search_controller nodes;
+                         nodes.node_budget = 100000;
+                         auto partial = longest_increasing_anytime(input, nodes);
+                         TEST_EQUAL("node budget", SEARCH_NODE_BUDGET, partial.status);
+                         TEST_EQUAL("nodes", uint64_t(100000), partial.progress.nodes);
+                         TEST_TRUE("best so far", is_increasing(partial.best) &&
+                                   partial.best.size() == partial.progress.best_length &&
+                                   partial.best.size() <= complete.size());
+                         TEST_TRUE("partly covered", partial.progress.covered > 0.0059 &&
+                                   partial.progress.covered < 0.006);
+
+                         // cancelled from the progress callback after two reports
+                         search_controller cancelling;
+                         size_t reports = 0;
+                         cancelling.progress_interval = 0;
+                         cancelling.on_progress = [&](const search_progress&) {
+                           if (++reports == 2) {
+                             cancelling.cancel();
+                           }
+                         };
+                         auto cancelled = longest_increasing_anytime(input, cancelling);
+                         TEST_EQUAL("cancelled", SEARCH_CANCELLED, cancelled.status);
+                         TEST_EQUAL("cancelled nodes", 2 * ANYTIME_SLICE, cancelled.progress.nodes);
+                         TEST_EQUAL("final report", size_t(3), reports);
+
+                         // the controller is reusable once the cancelled run returns
+                         cancelling.on_progress = nullptr;
+                         TEST_FALSE("cancel cleared", cancelling.cancelled());
+                         TEST_EQUAL("reused", complete, longest_increasing_anytime(input, cancelling).best);
+
+                         // a cancel before the run starts stops it at once
+                         cancelling.cancel();
+                         TEST_EQUAL("cancelled early", SEARCH_CANCELLED,
+                                    longest_increasing_anytime(input, cancelling).status);
+
+                         // 2^50 subsets would take days
+                         search_controller timed;
+                         timed.time_budget = 0.05;
+                         Timer timer;
+                         auto stopped = longest_increasing_anytime(random_sequence(50, 3, 1000), timed);
+                         TEST_EQUAL("time budget", SEARCH_TIME_BUDGET, stopped.status);
+                         TEST_TRUE("bounded latency", timer.elapsed() < 1.0);
+                     });
+
+    rubric.criterion("checkpoint and resume", 1,
+                     [&]() {
+                         const std::string path = "checkpoint_test.bin";
+                         std::remove(path.c_str());
+                         const auto input = random_sequence(22, 5, 1000);
+                         const auto uninterrupted = longest_increasing_gray_code(input);
+
+                         // preempted after every 300000 subsets, then resumed
+                         search_controller control;
+                         control.checkpoint_path = path;
+                         control.node_budget = 300000;
+                         size_t runs = 0;
+                         anytime_result result;
+                         do {
+                           result = resume_longest_increasing(input, control);
+                           ++runs;
+                         } while (!result.complete());
+                         TEST_EQUAL("runs", size_t(14), runs);
+                         TEST_EQUAL("resumed result", uninterrupted, result.best);
+
+                         // resuming a finished search returns at once
+                         TEST_EQUAL("finished", uninterrupted, resume_longest_increasing(input, control).best);
+
+                         bool rejected = false;
+                         try {
+                           resume_longest_increasing(random_sequence(22, 6, 1000), control);
+                         } catch (const std::runtime_error&) {
+                           rejected = true;
+                         }
+                         TEST_TRUE("different input", rejected);
+                         std::remove(path.c_str());
+                     });
+
+    rubric.criterion("exhaustive framework", 1,
+                     [&]() {
+                         // another problem: the largest subset sum within a capacity
+                         const std::vector<int> weights{31, 7, 19, 12, 25, 3, 17};
+                         const int capacity = 50;
+                         auto total = [&](const std::vector<size_t>& indices) {
+                           int sum = 0;
+                           for (auto i : indices) {
+                             sum += weights[i];
+                           }
+                           return sum;
+                         };
+                         auto fits = [&](const std::vector<size_t>& indices) {
+                           return total(indices) <= capacity;
+                         };
+                         auto result = exhaustive_search(subset_generator(weights.size()), fits, total);
+                         int brute_force = 0;
+                         for (unsigned mask = 0; mask < (1u << weights.size()); ++mask) {
+                           int sum = 0;
+                           for (size_t i = 0; i < weights.size(); ++i) {
+                             sum += mask & (1u << i) ? weights[i] : 0;
+                           }
+                           if (sum <= capacity) {
+                             brute_force = std::max(brute_force, sum);
+                           }
+                         }
+                         TEST_TRUE("found", result.found);
+                         TEST_EQUAL("subset sum", brute_force, result.score);
+                         TEST_EQUAL("subset", result.score, total(result.best));
+
+                         // the parallel search returns the same subset
+                         work_stealing_pool pool(4);
+                         const size_t n = weights.size();
+                         auto parallel = parallel_exhaustive_search(pool, n,
+                                                                    [n](size_t begin, size_t end) {
+                                                                      return subset_generator(n, begin, end);
+                                                                    },
+                                                                    fits, total, no_bound(), 0);
+                         TEST_EQUAL("parallel subset sum", result.score, parallel.score);
+                         TEST_EQUAL("parallel subset", result.best, parallel.best);
+                     });
   
   return rubric.run();
 }
@@ -16,8 +16,12 @@
 
 #include "timer.hpp"
 
+#include "lis_anytime.hpp"
+#include "lis_parallel.hpp"
 #include "subsequence.hpp"
 
+using namespace exhaustive;
+
 void print_bar() {
   std::cout << std::string(79, '-') << std::endl;
 }
@@ -47,6 +51,45 @@ int main() {
             << "of length = " << powerset_output.size() << std::endl;
   std::cout << "elapsed time=" << elapsed << " seconds" << std::endl;
 
+  print_bar();
+  std::cout << "branch and bound" << std::endl;
+  timer.reset();
+  auto bound_output = longest_increasing_branch_and_bound(input);
+  elapsed = timer.elapsed();
+  std::cout << "output = " << sequence_to_string(bound_output) << std::endl
+            << "of length = " << bound_output.size() << std::endl;
+  std::cout << "elapsed time=" << elapsed << " seconds" << std::endl;
+
+  // the pruned searches reach sizes the powerset search cannot
+  work_stealing_pool pool;
+  for (size_t large_n : {100, 300, 1000}) {
+    auto large_input = random_sequence(large_n, 0, 1000000);
+    timer.reset();
+    auto large_output = longest_increasing_branch_and_bound(large_input);
+    elapsed = timer.elapsed();
+    std::cout << "n = " << large_n << ", length = " << large_output.size()
+              << ", elapsed time=" << elapsed << " seconds";
+    timer.reset();
+    auto parallel_output = longest_increasing_parallel(large_input, pool);
+    elapsed = timer.elapsed();
+    assert(parallel_output == large_output);
+    std::cout << ", " << pool.size() << " threads=" << elapsed << " seconds" << std::endl;
+  }
+
+  // a capped run of the exhaustive search at a size that takes hours
+  print_bar();
+  std::cout << "anytime gray code, n = 34, 2 second budget" << std::endl;
+  search_controller control;
+  control.time_budget = 2;
+  control.progress_interval = 0.5;
+  control.on_progress = [](const search_progress& progress) {
+    std::cout << "covered " << 100 * progress.covered << "%, best length "
+              << progress.best_length << ", " << progress.elapsed << " seconds" << std::endl;
+  };
+  auto anytime_output = longest_increasing_anytime(random_sequence(34, 0, 1000), control);
+  std::cout << "output = " << sequence_to_string(anytime_output.best) << std::endl
+            << (anytime_output.complete() ? "complete" : "stopped early") << std::endl;
+
   print_bar();
 
   return 0;